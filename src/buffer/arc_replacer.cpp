@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : nodes_(num_frames), capacity_(num_frames) {}
+
+auto ARCReplacer::EvictionOrder() -> std::vector<std::list<frame_id_t> *> {
+  // T1 超过目标大小p时从T1驱逐, 否则从T2驱逐; 首选的列表里没有可驱逐的frame时再看另一个
+  if (!recent_.empty() && recent_.size() > target_recent_) {
+    return {&recent_, &frequent_};
+  }
+  return {&frequent_, &recent_};
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  for (auto *list : EvictionOrder()) {
+    for (auto iter = list->begin(); iter != list->end(); ++iter) {
+      auto &node = nodes_[*iter];
+      if (!node.is_evictable_ || !can_evict(*iter)) {
+        continue;
+      }
+      *frame_id = *iter;
+      list->erase(iter);
+      if (node.page_id_ != INVALID_PAGE_ID) {
+        Remember(node.queue_, node.page_id_);
+      }
+      node = Node{};
+      --curr_size_;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ARCReplacer::Victims(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  std::vector<frame_id_t> victims;
+  for (auto *list : EvictionOrder()) {
+    for (auto iter = list->begin(); iter != list->end() && victims.size() < n; ++iter) {
+      if (nodes_[*iter].is_evictable_) {
+        victims.push_back(*iter);
+      }
+    }
+  }
+  return victims;
+}
+
+void ARCReplacer::Remember(Queue queue, page_id_t page_id) {
+  if (ghosts_.count(page_id) != 0) {
+    return;
+  }
+  auto &ghosts = GhostsOf(queue);
+  ghosts_[page_id] = {queue, ghosts.insert(ghosts.end(), page_id)};
+  // |T1| + |B1| <= c, |B1| + |B2| <= c
+  auto forget_oldest = [this](std::list<page_id_t> &list) {
+    ghosts_.erase(list.front());
+    list.pop_front();
+  };
+  while (!recent_ghosts_.empty() && recent_.size() + recent_ghosts_.size() > capacity_) {
+    forget_oldest(recent_ghosts_);
+  }
+  while (recent_ghosts_.size() + frequent_ghosts_.size() > capacity_) {
+    forget_oldest(frequent_ghosts_.empty() ? recent_ghosts_ : frequent_ghosts_);
+  }
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size())) {
+    throw std::runtime_error("RecordAccess: frame_id larger than replacer size");
+  }
+  auto &node = nodes_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.queue_ != Queue::None) {
+    // 命中: 移到T2的MRU端
+    if (!is_scan) {
+      auto &list = node.queue_ == Queue::Recent ? recent_ : frequent_;
+      frequent_.splice(frequent_.end(), list, node.pos_);
+      node.queue_ = Queue::Frequent;
+    }
+    return;
+  }
+  node.page_id_ = page_id;
+  auto ghost = page_id == INVALID_PAGE_ID ? ghosts_.end() : ghosts_.find(page_id);
+  if (ghost == ghosts_.end() || is_scan) {
+    if (ghost != ghosts_.end()) {
+      GhostsOf(ghost->second.queue_).erase(ghost->second.pos_);
+      ghosts_.erase(ghost);
+    }
+    node.queue_ = Queue::Recent;
+    node.pos_ = recent_.insert(recent_.end(), frame_id);
+    return;
+  }
+  // 幽灵命中: 在B1中说明T1太小, 在B2中说明T2太小
+  size_t recent_ghosts = recent_ghosts_.size();
+  size_t frequent_ghosts = frequent_ghosts_.size();
+  if (ghost->second.queue_ == Queue::Recent) {
+    size_t delta = std::max<size_t>(frequent_ghosts / recent_ghosts, 1);
+    target_recent_ = std::min(capacity_, target_recent_ + delta);
+  } else {
+    size_t delta = std::max<size_t>(recent_ghosts / frequent_ghosts, 1);
+    target_recent_ = target_recent_ > delta ? target_recent_ - delta : 0;
+  }
+  GhostsOf(ghost->second.queue_).erase(ghost->second.pos_);
+  ghosts_.erase(ghost);
+  node.queue_ = Queue::Frequent;
+  node.pos_ = frequent_.insert(frequent_.end(), frame_id);
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || nodes_[frame_id].queue_ == Queue::None) {
+    throw std::runtime_error("SetEvictable: no such frame");
+  }
+  auto &node = nodes_[frame_id];
+  if (node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    ++curr_size_;
+  } else {
+    --curr_size_;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || nodes_[frame_id].queue_ == Queue::None) {
+    return;
+  }
+  auto &node = nodes_[frame_id];
+  if (!node.is_evictable_) {
+    throw std::runtime_error("Remove: remove a non-evictable node");
+  }
+  (node.queue_ == Queue::Recent ? recent_ : frequent_).erase(node.pos_);
+  node = Node{};
+  --curr_size_;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  return curr_size_;
+}
+
+auto ARCReplacer::GetTargetRecentSize() -> size_t {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  return target_recent_;
+}
+
+}  // namespace bustub
@@ -11,234 +11,762 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <new>
 #include <stdexcept>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/exception.h"
+#include "common/macros.h"
+#include "fmt/format.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // TODO(students): remove this line after you have implemented the buffer pool manager
+                                     LogManager *log_manager, size_t num_shards, bool use_huge_pages,
+                                     ReplacerPolicy replacer_policy, size_t max_pool_size)
+    : pool_size_(pool_size),
+      capacity_(std::max(pool_size, max_pool_size)),
+      replacer_policy_(replacer_policy),
+      arena_(std::make_unique<FrameArena>(capacity_, use_huge_pages)),
+      disk_manager_(disk_manager),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)),
+      log_manager_(log_manager) {
+  BUSTUB_ENSURE(num_shards > 0 && num_shards <= pool_size, "every shard needs at least one frame");
 
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  for (size_t i = 0; i < pool_size_; ++i) {
+  // we allocate a consecutive memory space for the buffer pool, the page data of every frame comes from the arena
+  pages_ = static_cast<Page *>(::operator new[](capacity_ * sizeof(Page), std::align_val_t{alignof(Page)}));
+  for (size_t i = 0; i < capacity_; ++i) {
+    new (&pages_[i]) Page(arena_->GetFrameData(i));
     pages_[i].page_id_ = INVALID_PAGE_ID;
     pages_[i].pin_count_ = 0;
     pages_[i].is_dirty_ = false;
   }
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  frame_io_.resize(capacity_);
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  // Frames are split into contiguous ranges, the first capacity % num_shards shards get one frame more.
+  shards_.reserve(num_shards);
+  size_t frame_begin = 0;
+  for (size_t i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<Shard>();
+    shard->frame_begin_ = static_cast<frame_id_t>(frame_begin);
+    shard->capacity_ = capacity_ / num_shards + (i < capacity_ % num_shards ? 1 : 0);
+    shard->size_ = pool_size / num_shards + (i < pool_size % num_shards ? 1 : 0);
+    shard->index_ = i;
+    shard->page_table_ = std::make_unique<PageTable>(shard->capacity_);
+    shard->replacer_ = MakeReplacer(replacer_policy, shard->capacity_, replacer_k);
+    // Initially, every page is in the free list. Frames past the pool size are released until the pool grows.
+    for (size_t j = 0; j < shard->capacity_; ++j) {
+      if (j < shard->size_) {
+        shard->free_list_.emplace_back(static_cast<frame_id_t>(frame_begin + j));
+      } else {
+        pages_[frame_begin + j].pin_count_ = -1;
+      }
+    }
+    frame_begin += shard->capacity_;
+    shards_.emplace_back(std::move(shard));
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+  StopFlushThread();
+  // Drain in-flight I/O before the frames and write-back copies it uses are freed.
+  disk_scheduler_.reset();
+  for (size_t i = 0; i < capacity_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_, std::align_val_t{alignof(Page)});
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  // 是否有可用的frame
-  Page *p = nullptr;
-  if (!free_list_.empty()) {
-    // 有空余的frame
-    // 取frame_id 和page_id绑定
-    // 初始化page结构体
-    frame_id_t frame_id = free_list_.front();
-    free_list_.pop_front();
-    *page_id = AllocatePage();
-    for (size_t i = 0; i < pool_size_; ++i) {
-      if (pages_[i].page_id_ == INVALID_PAGE_ID) {
-        p = &pages_[i];
-        break;
-      }
+auto BufferPoolManager::AcquireFrame(Shard &shard, frame_id_t *frame_id) -> bool {
+  ReapPrefetches(shard);
+  DrainAccesses(shard);
+  RetireFrames(shard);
+  if (!shard.free_list_.empty()) {
+    *frame_id = shard.free_list_.front();
+    shard.free_list_.pop_front();
+    // 空闲frame可能被持有过期页表项的无锁读者短暂pin住, 它们验证失败后马上会释放
+    int expected = 0;
+    if (!pages_[*frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
+      num_pin_waits_.Add();
+      do {
+        expected = 0;
+        std::this_thread::yield();
+      } while (!pages_[*frame_id].pin_count_.compare_exchange_weak(expected, -1));
     }
-    p->page_id_ = *page_id;
-    p->is_dirty_ = false;
-    p->pin_count_ = 1;
-    page_table_[*page_id] = frame_id;
-    frame_table_[frame_id] = p;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-  } else {
-    // 需要驱逐获得frame
-    frame_id_t frame_id = 0;
-    if (!replacer_->Evict(&frame_id)) {
-      // 驱逐失败
-      return nullptr;
-    }
-    p = frame_table_[frame_id];
-    page_table_.erase(p->page_id_);
-    *page_id = AllocatePage();
-    if (p->IsDirty()) {
-      disk_manager_->WritePage(p->page_id_, p->GetData());
-      p->is_dirty_ = false;
-    }
-    p->ResetMemory();
-    p->is_dirty_ = false;
-    p->page_id_ = *page_id;
-    p->pin_count_ = 1;
-    page_table_[*page_id] = frame_id;
-    frame_table_[frame_id] = p;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
+    pages_[*frame_id].version_ += 2;
+    return true;
   }
-  return p;
+  // replacer 只决定驱逐顺序, 是否被pin由pin count决定: 把 0 换成 -1 之后, 无锁路径就不能再pin住这个frame
+  frame_id_t victim = 0;
+  // 缩容后超出size_的frame只等着被回收, 不再复用
+  bool evicted = shard.replacer_->Evict(&victim, [this, &shard](frame_id_t candidate) {
+    int expected = 0;
+    return static_cast<size_t>(candidate) < shard.size_ &&
+           pages_[shard.frame_begin_ + candidate].pin_count_.compare_exchange_strong(expected, -1);
+  });
+  if (!evicted) {
+    num_no_evictable_frames_.Add();
+    return false;
+  }
+  num_evictions_.Add();
+  *frame_id = shard.frame_begin_ + victim;
+  EvictFrame(shard, *frame_id);
+  return true;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  frame_id_t frame_id = 0;
-  if (page_table_.count(page_id) == 0) {
-    // page 不在buffer 中
-    if (free_list_.empty()) {
-      // 没有空余的frame
-      frame_id = 0;
-      if (!replacer_->Evict(&frame_id)) {
-        // 无法驱逐
-        return nullptr;
-      }
-      Page *p = frame_table_[frame_id];
-      if (p->IsDirty()) {
-        disk_manager_->WritePage(p->page_id_, p->GetData());
-        p->is_dirty_ = false;
-      }
-      // 移除老的 frame 和 pagetable中的记录
-      page_table_.erase(p->page_id_);
-      frame_table_[frame_id] = p;
-      p->page_id_ = page_id;
-      p->is_dirty_ = false;
-      p->pin_count_ = 1;
-      p->ResetMemory();
-      disk_manager_->ReadPage(page_id, p->GetData());
-      page_table_[page_id] = frame_id;
-      replacer_->RecordAccess(frame_id);
-      replacer_->SetEvictable(frame_id, false);
-    } else {
-      // 有空余的frame
-      frame_id = free_list_.front();
-      Page *p = nullptr;
-      free_list_.pop_front();
-      for (size_t i = 0; i < pool_size_; ++i) {
-        if (pages_[i].page_id_ == INVALID_PAGE_ID) {
-          p = &pages_[i];
-          break;
+void BufferPoolManager::EvictFrame(Shard &shard, frame_id_t frame_id) {
+  Page *p = &pages_[frame_id];
+  // 乐观读者之前拿到的版本号全部失效
+  p->version_ += 2;
+  shard.page_table_->Erase(p->page_id_);
+  ClearSwips(p);
+  if (p->IsDirty()) {
+    num_dirty_victims_.Add();
+    // 脏页拷贝一份后异步写回, frame可以立即复用
+    if (shard.write_back_.size() >= shard.size_) {
+      for (auto iter = shard.write_back_.begin(); iter != shard.write_back_.end();) {
+        if (iter->second.io_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+          iter = shard.write_back_.erase(iter);
+        } else {
+          ++iter;
         }
       }
-      if (p == nullptr) {
-        free_list_.push_front(frame_id);
-        return nullptr;
+    }
+    auto data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+    memcpy(data.get(), p->GetData(), BUSTUB_PAGE_SIZE);
+    auto io = disk_scheduler_->ScheduleWrite(p->page_id_, data.get()).share();
+    shard.write_back_[p->page_id_] = {std::move(io), std::move(data)};
+    p->is_dirty_ = false;
+  }
+}
+
+void BufferPoolManager::RetireFrames(Shard &shard) {
+  auto iter = shard.draining_.begin();
+  while (iter != shard.draining_.end()) {
+    frame_id_t frame_id = *iter;
+    Page *p = &pages_[frame_id];
+    int expected = 0;
+    if (!p->pin_count_.compare_exchange_strong(expected, -1)) {
+      ++iter;
+      continue;
+    }
+    // 和驱逐一样写回脏页, 然后把frame的内存还给操作系统, pin count保持-1
+    EvictFrame(shard, frame_id);
+    shard.replacer_->Remove(frame_id - shard.frame_begin_);
+    p->page_id_ = INVALID_PAGE_ID;
+    arena_->Release(frame_id);
+    iter = shard.draining_.erase(iter);
+  }
+}
+
+void BufferPoolManager::ResizeShard(Shard &shard, size_t size) {
+  auto frame_end = static_cast<frame_id_t>(shard.frame_begin_ + size);
+  if (size > shard.size_) {
+    // 还没回收的frame直接留用, 已释放的frame放进空闲链表
+    for (auto frame_id = static_cast<frame_id_t>(shard.frame_begin_ + shard.size_); frame_id < frame_end; ++frame_id) {
+      auto iter = std::find(shard.draining_.begin(), shard.draining_.end(), frame_id);
+      if (iter != shard.draining_.end()) {
+        shard.draining_.erase(iter);
+        continue;
       }
-      page_table_[page_id] = frame_id;
-      frame_table_[frame_id] = p;
-      p->page_id_ = page_id;
-      p->is_dirty_ = false;
-      p->pin_count_ = 1;
-      p->ResetMemory();
-      disk_manager_->ReadPage(page_id, p->GetData());
-      replacer_->RecordAccess(frame_id);
-      replacer_->SetEvictable(frame_id, false);
+      pages_[frame_id].pin_count_ = 0;
+      shard.free_list_.push_back(frame_id);
     }
-  } else {
-    frame_id = page_table_[page_id];
-    Page *p = frame_table_[frame_id];
-    ++p->pin_count_;
-    replacer_->RecordAccess(frame_id);
-    if (p->pin_count_ == 1) {
-      replacer_->SetEvictable(frame_id, false);
+    shard.size_ = size;
+    return;
+  }
+  for (auto iter = shard.free_list_.begin(); iter != shard.free_list_.end();) {
+    frame_id_t frame_id = *iter;
+    if (frame_id < frame_end) {
+      ++iter;
+      continue;
+    }
+    // 空闲frame可能被持有过期页表项的无锁读者短暂pin住, 等它们释放
+    int expected = 0;
+    while (!pages_[frame_id].pin_count_.compare_exchange_weak(expected, -1)) {
+      expected = 0;
+      std::this_thread::yield();
     }
+    pages_[frame_id].version_ += 2;
+    arena_->Release(frame_id);
+    iter = shard.free_list_.erase(iter);
+  }
+  // 其余超出新大小的frame装着页面, 先放进draining_, 没被pin的马上回收, 被pin的等unpin之后再回收
+  for (auto frame_id = frame_end; frame_id < static_cast<frame_id_t>(shard.frame_begin_ + shard.size_); ++frame_id) {
+    shard.draining_.push_back(frame_id);
   }
-  return frame_table_[frame_id];
+  shard.size_ = size;
+  ReapPrefetches(shard);
+  DrainAccesses(shard);
+  RetireFrames(shard);
 }
 
-auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  if (page_table_.count(page_id) == 0) {
-    return false;
+void BufferPoolManager::Resize(size_t pool_size) {
+  std::lock_guard<std::mutex> resize_lkgd(resize_latch_);
+  if (pool_size < shards_.size() || pool_size > capacity_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE,
+                    fmt::format("buffer pool size must be between {} and {}", shards_.size(), capacity_));
+  }
+  size_t num_shards = shards_.size();
+  for (size_t i = 0; i < num_shards; ++i) {
+    std::lock_guard<std::mutex> lkgd(shards_[i]->latch_);
+    ResizeShard(*shards_[i], pool_size / num_shards + (i < pool_size % num_shards ? 1 : 0));
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *p = frame_table_[frame_id];
-  if (p->pin_count_ == 0) {
+  pool_size_ = pool_size;
+}
+
+void BufferPoolManager::InstallPage(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  Page *p = &pages_[frame_id];
+  p->page_id_ = page_id;
+  p->is_dirty_ = false;
+  p->is_loaded_ = false;
+  // 最后才把pin从-1改成1, 之前无锁路径无法pin住这个frame
+  p->pin_count_ = 1;
+  shard.page_table_->Insert(page_id, frame_id);
+  shard.replacer_->RecordAccess(frame_id - shard.frame_begin_, access_type, page_id);
+  shard.replacer_->SetEvictable(frame_id - shard.frame_begin_, true);
+}
+
+auto BufferPoolManager::FetchChild(Page *parent, size_t slot, page_id_t child_id, AccessType access_type) -> Page * {
+  if (slot >= SWIPS_PER_FRAME) {
+    return FetchPage(child_id, access_type);
+  }
+  std::atomic<frame_id_t> &swip = GetSwip(parent, slot);
+
+  // swip只是提示, 和无锁命中一样先pin再验证frame里是不是这个页面
+  frame_id_t frame_id = swip.load(std::memory_order_relaxed);
+  if (frame_id != NO_SWIP && TryPin(&pages_[frame_id], child_id)) {
+    RecordHit(GetShard(child_id), frame_id, child_id, access_type);
+    return &pages_[frame_id];
+  }
+  Page *p = FetchPage(child_id, access_type);
+  if (p != nullptr) {
+    swip.store(static_cast<frame_id_t>(p - pages_), std::memory_order_relaxed);
+  }
+  return p;
+}
+
+auto BufferPoolManager::GetSwip(Page *parent, size_t slot) -> std::atomic<frame_id_t> & {
+  // 第一次使用时才分配, 之后直到Page析构都不会释放, 即使父页面没被pin住也可以安全访问
+  auto *swips = parent->swips_.load(std::memory_order_acquire);
+  if (swips == nullptr) {
+    auto *fresh = new std::atomic<frame_id_t>[SWIPS_PER_FRAME];
+    for (size_t i = 0; i < SWIPS_PER_FRAME; ++i) {
+      fresh[i].store(NO_SWIP, std::memory_order_relaxed);
+    }
+    if (parent->swips_.compare_exchange_strong(swips, fresh, std::memory_order_acq_rel)) {
+      swips = fresh;
+    } else {
+      delete[] fresh;
+    }
+  }
+  return swips[slot];
+}
+
+void BufferPoolManager::ClearSwips(Page *p) {
+  auto *swips = p->swips_.load(std::memory_order_relaxed);
+  if (swips == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < SWIPS_PER_FRAME; ++i) {
+    swips[i].store(NO_SWIP, std::memory_order_relaxed);
+  }
+}
+
+auto BufferPoolManager::TryOptimistic(Page *p, page_id_t page_id, OptimisticReadGuard *guard) -> bool {
+  // 先读版本号再检查frame: 之后frame被占用换页或者被写, 版本号都会变, 验证就会失败
+  uint64_t version = p->GetVersion();
+  if (version % 2 != 0 || p->pin_count_ < 0 || p->page_id_ != page_id || !p->is_loaded_ || IsRetiring(p, page_id)) {
     return false;
   }
+  *guard = {p, page_id, version};
+  return true;
+}
+
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticReadGuard {
+  Shard &shard = GetShard(page_id);
+  OptimisticReadGuard guard;
+  frame_id_t frame_id = 0;
+  if (shard.page_table_->Find(page_id, &frame_id) && TryOptimistic(&pages_[frame_id], page_id, &guard)) {
+    RecordHit(shard, frame_id, page_id, access_type);
+    return guard;
+  }
+  // 不在buffer中或者正在被写: pin住(必要时读盘), 在读锁下取版本号
+  Page *p = FetchPage(page_id, access_type);
+  if (p == nullptr) {
+    return guard;
+  }
+  p->RLatch();
+  guard = {p, page_id, p->GetVersion()};
+  p->RUnlatch();
+  Unpin(p, false);
+  return guard;
+}
+
+auto BufferPoolManager::FetchChildOptimistic(const OptimisticReadGuard &parent, size_t slot, page_id_t child_id,
+                                             AccessType access_type) -> OptimisticReadGuard {
+  if (slot >= SWIPS_PER_FRAME) {
+    return FetchPageOptimistic(child_id, access_type);
+  }
+  std::atomic<frame_id_t> &swip = GetSwip(parent.page_, slot);
+  OptimisticReadGuard guard;
+  frame_id_t frame_id = swip.load(std::memory_order_relaxed);
+  if (frame_id != NO_SWIP && TryOptimistic(&pages_[frame_id], child_id, &guard)) {
+    RecordHit(GetShard(child_id), frame_id, child_id, access_type);
+    return guard;
+  }
+  guard = FetchPageOptimistic(child_id, access_type);
+  if (guard.page_ != nullptr) {
+    swip.store(static_cast<frame_id_t>(guard.page_ - pages_), std::memory_order_relaxed);
+  }
+  return guard;
+}
+
+void BufferPoolManager::ReapPrefetches(Shard &shard) {
+  auto iter = shard.prefetching_.begin();
+  while (iter != shard.prefetching_.end()) {
+    frame_id_t frame_id = *iter;
+    if (frame_io_[frame_id].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++iter;
+      continue;
+    }
+    Page *p = &pages_[frame_id];
+    p->is_loaded_ = true;
+    --p->pin_count_;
+    iter = shard.prefetching_.erase(iter);
+  }
+}
+
+auto BufferPoolManager::TryPin(Page *p, page_id_t page_id) -> bool {
+  int pins = p->pin_count_.load();
+  do {
+    if (pins < 0) {
+      return false;
+    }
+  } while (!p->pin_count_.compare_exchange_weak(pins, pins + 1));
+  // pin住之后frame不会再被换出, 再检查它装的是不是要找的页面. 缩容后待回收的frame走加锁路径, 好尽快回收
+  if (p->page_id_ == page_id && p->is_loaded_ && !IsRetiring(p, page_id)) {
+    return true;
+  }
   --p->pin_count_;
-  p->is_dirty_ |= is_dirty;
-  if (p->pin_count_ == 0) {
-    replacer_->SetEvictable(frame_id, true);
+  return false;
+}
+
+auto BufferPoolManager::Unpin(Page *p, bool is_dirty) -> bool {
+  int pins = p->pin_count_.load();
+  if (pins <= 0) {
+    return false;
+  }
+  // 先置脏再减pin, 驱逐者拿到pin为0的frame时一定能看到脏标记
+  if (is_dirty) {
+    p->is_dirty_ = true;
+  }
+  do {
+    if (pins <= 0) {
+      return false;
+    }
+  } while (!p->pin_count_.compare_exchange_weak(pins, pins - 1));
+  return true;
+}
+
+void BufferPoolManager::RecordHit(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  num_hits_.Add();
+  size_t idx = shard.access_head_.fetch_add(1);
+  if (idx < Shard::ACCESS_BUFFER_SIZE) {
+    uint64_t access = (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) |
+                      (static_cast<uint64_t>(frame_id) << 4) | 8 | static_cast<uint64_t>(access_type);
+    shard.access_buffer_[idx] = access;
+    return;
+  }
+  // 缓冲区已满: 拿得到latch就顺便清空, 否则丢掉这次访问记录
+  std::unique_lock<std::mutex> lk(shard.latch_, std::try_to_lock);
+  if (lk.owns_lock()) {
+    DrainAccesses(shard);
+    shard.replacer_->RecordAccess(frame_id - shard.frame_begin_, access_type, page_id);
+  }
+}
+
+void BufferPoolManager::DrainAccesses(Shard &shard) {
+  size_t n = std::min(shard.access_head_.load(), Shard::ACCESS_BUFFER_SIZE);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t access = shard.access_buffer_[i].exchange(0);
+    if (access == 0) {
+      continue;
+    }
+    auto page_id = static_cast<page_id_t>(access >> 32);
+    auto frame_id = static_cast<frame_id_t>((access & 0xFFFFFFFF) >> 4);
+    // 记录之后frame可能已经换了页面, 这样的访问直接丢弃
+    if (pages_[frame_id].page_id_ == page_id) {
+      shard.replacer_->RecordAccess(frame_id - shard.frame_begin_, static_cast<AccessType>(access & 7), page_id);
+    }
+  }
+  shard.access_head_ = 0;
+}
+
+auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+  // 轮流从各个shard分配新页面, 当前shard满了就尝试下一个
+  size_t start = next_shard_++;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    Page *p = NewPageInShard(*shards_[(start + i) % shards_.size()], page_id);
+    if (p != nullptr) {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+auto BufferPoolManager::NewPageInShard(Shard &shard, page_id_t *page_id) -> Page * {
+  std::unique_lock<std::mutex> lk(shard.latch_);
+  frame_id_t frame_id = 0;
+  if (!AcquireFrame(shard, &frame_id)) {
+    return nullptr;
+  }
+  *page_id = AllocatePage(shard);
+  InstallPage(shard, frame_id, *page_id, AccessType::Unknown);
+  frame_io_[frame_id] = {};
+  lk.unlock();
+
+  Page *p = &pages_[frame_id];
+  p->ResetMemory();
+  p->is_loaded_ = true;
+  return p;
+}
+
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  Shard &shard = GetShard(page_id);
+  // 快速路径: 无锁查页表, 原子地pin住frame, 访问记录延后交给replacer
+  frame_id_t frame_id = 0;
+  if (shard.page_table_->Find(page_id, &frame_id) && TryPin(&pages_[frame_id], page_id)) {
+    RecordHit(shard, frame_id, page_id, access_type);
+    return &pages_[frame_id];
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lk(shard.latch_);
+  RetireFrames(shard);
+  if (shard.page_table_->Find(page_id, &frame_id)) {
+    // page 在buffer中, 但可能还在被其他线程读入
+    Page *p = &pages_[frame_id];
+    ++p->pin_count_;
+    DrainAccesses(shard);
+    shard.replacer_->RecordAccess(frame_id - shard.frame_begin_, access_type, page_id);
+    auto io = frame_io_[frame_id];
+    lk.unlock();
+    num_hits_.Add();
+    if (!p->is_loaded_) {
+      num_pin_waits_.Add();
+    }
+    WaitForIo(io);
+    return p;
   }
 
+  // page 不在buffer中: 在latch下占用一个frame, 然后在latch外读盘
+  if (!AcquireFrame(shard, &frame_id)) {
+    return nullptr;
+  }
+  Page *p = &pages_[frame_id];
+  InstallPage(shard, frame_id, page_id, access_type);
+  num_misses_.Add();
+
+  WriteBack write_back;
+  auto wb = shard.write_back_.find(page_id);
+  if (wb != shard.write_back_.end()) {
+    write_back = std::move(wb->second);
+    shard.write_back_.erase(wb);
+  }
+  auto read_done = disk_scheduler_->CreatePromise();
+  frame_io_[frame_id] = read_done.get_future().share();
+  auto read_io = frame_io_[frame_id];
+  lk.unlock();
+
+  if (write_back.data_ != nullptr) {
+    // 页面刚被驱逐, 直接从写回的拷贝恢复. 等写回完成再释放拷贝, 同一页面的写盘也不会乱序
+    memcpy(p->GetData(), write_back.data_.get(), BUSTUB_PAGE_SIZE);
+    read_done.set_value(true);
+    p->is_loaded_ = true;
+    WaitForIo(write_back.io_);
+    fetch_miss_latency_.RecordSince(start);
+    return p;
+  }
+  disk_scheduler_->Schedule({/*is_write=*/false, p->GetData(), page_id, std::move(read_done)});
+  WaitForIo(read_io);
+  p->is_loaded_ = true;
+  fetch_miss_latency_.RecordSince(start);
+  return p;
+}
+
+auto BufferPoolManager::PrefetchPage(page_id_t page_id) -> bool {
+  Shard &shard = GetShard(page_id);
+  std::lock_guard<std::mutex> lkgd(shard.latch_);
+  ReapPrefetches(shard);
+  frame_id_t frame_id = 0;
+  if (shard.page_table_->Find(page_id, &frame_id) || shard.prefetching_.size() >= shard.size_ / 4) {
+    return false;
+  }
+  auto wb = shard.write_back_.find(page_id);
+  if (wb != shard.write_back_.end()) {
+    if (wb->second.io_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return false;
+    }
+    shard.write_back_.erase(wb);
+  }
+  if (!AcquireFrame(shard, &frame_id)) {
+    return false;
+  }
+  // 读盘期间由预取持有一个pin, 读完后在ReapPrefetches中释放
+  Page *p = &pages_[frame_id];
+  InstallPage(shard, frame_id, page_id, AccessType::Scan);
+  frame_io_[frame_id] = disk_scheduler_->ScheduleRead(page_id, p->GetData()).share();
+  shard.prefetching_.push_back(frame_id);
   return true;
 }
 
+auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+  Shard &shard = GetShard(page_id);
+  frame_id_t frame_id = 0;
+  // 调用者持有pin时frame不会被换出, 无锁查到的frame就是这个页面的
+  if (shard.page_table_->Find(page_id, &frame_id) && pages_[frame_id].page_id_ == page_id) {
+    return Unpin(&pages_[frame_id], is_dirty);
+  }
+  std::lock_guard<std::mutex> lkgd(shard.latch_);
+  if (!shard.page_table_->Find(page_id, &frame_id)) {
+    return false;
+  }
+  return Unpin(&pages_[frame_id], is_dirty);
+}
+
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  if (page_table_.count(page_id) == 0) {
+  std::lock_guard<std::mutex> flush_lkgd(flush_latch_);
+  Shard &shard = GetShard(page_id);
+  std::unique_lock<std::mutex> lk(shard.latch_);
+  frame_id_t frame_id = 0;
+  if (!shard.page_table_->Find(page_id, &frame_id)) {
     return false;
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *p = frame_table_[frame_id];
-  disk_manager_->WritePage(page_id, p->GetData());
+  // 写盘期间pin住页面, 防止frame被驱逐或复用
+  Page *p = &pages_[frame_id];
+  ++p->pin_count_;
   p->is_dirty_ = false;
+  auto io = frame_io_[frame_id];
+  lk.unlock();
+
+  WaitForIo(io);
+  disk_scheduler_->ScheduleWrite(page_id, p->GetData()).wait();
+  UnpinPage(page_id, false);
   return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  auto iter = page_table_.begin();
-  while (iter != page_table_.end()) {
-    auto page_id = iter->first;
-    disk_manager_->WritePage(page_id, frame_table_[page_table_[page_id]]->GetData());
-    frame_table_[page_table_[page_id]]->is_dirty_ = false;
+  std::vector<page_id_t> page_ids;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lkgd(shard->latch_);
+    shard->page_table_->ForEach([&page_ids](page_id_t page_id, frame_id_t) { page_ids.push_back(page_id); });
   }
+  for (auto page_id : page_ids) {
+    FlushPage(page_id);
+  }
+  disk_manager_->Sync();
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lkgd(latch_);
-  if (page_table_.count(page_id) == 0) {
-    return true;
+  Shard &shard = GetShard(page_id);
+  std::unique_lock<std::mutex> lk(shard.latch_);
+  frame_id_t frame_id = 0;
+  if (shard.page_table_->Find(page_id, &frame_id)) {
+    Page *p = &pages_[frame_id];
+    int expected = 0;
+    if (!p->pin_count_.compare_exchange_strong(expected, -1)) {
+      return false;
+    }
+    // 被删除的页面不需要写回
+    p->version_ += 2;
+    shard.page_table_->Erase(page_id);
+    shard.replacer_->Remove(frame_id - shard.frame_begin_);
+    p->page_id_ = INVALID_PAGE_ID;
+    p->is_dirty_ = false;
+    ClearSwips(p);
+    auto draining = std::find(shard.draining_.begin(), shard.draining_.end(), frame_id);
+    if (draining != shard.draining_.end()) {
+      // 缩容时这个frame被pin住, 现在直接回收
+      shard.draining_.erase(draining);
+      arena_->Release(frame_id);
+    } else {
+      p->ResetMemory();
+      shard.free_list_.push_back(frame_id);
+      p->pin_count_ = 0;
+    }
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *p = frame_table_[frame_id];
-  if (p->pin_count_ > 0) {
-    return false;
+  // 已被驱逐的页面可能还在写回. 写完之前页号不能被重新分配, 否则旧内容可能覆盖新页面
+  WriteBack write_back;
+  auto wb = shard.write_back_.find(page_id);
+  if (wb != shard.write_back_.end()) {
+    write_back = std::move(wb->second);
+    shard.write_back_.erase(wb);
   }
-  if (p->IsDirty()) {
-    disk_manager_->WritePage(p->page_id_, p->GetData());
+  lk.unlock();
+  WaitForIo(write_back.io_);
+  DeallocatePage(page_id);
+  return true;
+}
+
+void BufferPoolManager::RunFlushThread(std::chrono::milliseconds interval) {
+  StopFlushThread();
+  flush_thread_stop_ = false;
+  flush_thread_ = std::thread([this, interval] {
+    std::unique_lock<std::mutex> lk(flush_thread_latch_);
+    while (!flush_thread_cv_.wait_for(lk, interval, [this] { return flush_thread_stop_; })) {
+      lk.unlock();
+      FlushDirtyVictims();
+      lk.lock();
+    }
+  });
+}
+
+void BufferPoolManager::StopFlushThread() {
+  if (!flush_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lkgd(flush_thread_latch_);
+    flush_thread_stop_ = true;
+  }
+  flush_thread_cv_.notify_all();
+  flush_thread_.join();
+}
+
+auto BufferPoolManager::FlushDirtyVictims() -> size_t {
+  std::lock_guard<std::mutex> flush_lkgd(flush_latch_);
+  // 在shard latch下挑出即将被驱逐且未被pin的脏页并pin住, 写盘完成前它们不会被驱逐
+  std::vector<Page *> victims;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lkgd(shard->latch_);
+    for (auto victim : shard->replacer_->Victims(std::max<size_t>(shard->size_ / 4, 1))) {
+      Page *p = &pages_[shard->frame_begin_ + victim];
+      if (!p->IsDirty() || p->pin_count_ > 0) {
+        continue;
+      }
+      ++p->pin_count_;
+      victims.push_back(p);
+    }
+  }
+  if (victims.empty()) {
+    return 0;
+  }
+  // 无锁路径随时可能pin住并修改这些页面, 拷贝时要持有读latch. 先拷贝再清除脏标记, 之后的修改会在unpin时重新置脏
+  std::vector<std::pair<page_id_t, std::unique_ptr<char[]>>> dirty;
+  for (Page *p : victims) {
+    auto data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+    p->RLatch();
+    memcpy(data.get(), p->GetData(), BUSTUB_PAGE_SIZE);
     p->is_dirty_ = false;
+    p->RUnlatch();
+    dirty.emplace_back(p->GetPageId(), std::move(data));
   }
-  page_table_.erase(page_id);
-  frame_table_.erase(frame_id);
-  free_list_.push_back(frame_id);
-  p->page_id_ = INVALID_PAGE_ID;
-  p->is_dirty_ = false;
-  p->ResetMemory();
-  p->pin_count_ = 0;
-  replacer_->Remove(frame_id);
 
-  return true;
+  // 页号连续的页面合并成一次写盘
+  std::sort(dirty.begin(), dirty.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<std::unique_ptr<char[]>> buffers;
+  std::vector<std::future<bool>> ios;
+  for (size_t begin = 0; begin < dirty.size();) {
+    size_t end = begin + 1;
+    while (end < dirty.size() && dirty[end].first == dirty[end - 1].first + 1) {
+      ++end;
+    }
+    if (end - begin == 1) {
+      ios.push_back(disk_scheduler_->ScheduleWrite(dirty[begin].first, dirty[begin].second.get()));
+    } else {
+      auto data = std::make_unique<char[]>((end - begin) * BUSTUB_PAGE_SIZE);
+      for (size_t i = begin; i < end; ++i) {
+        memcpy(data.get() + (i - begin) * BUSTUB_PAGE_SIZE, dirty[i].second.get(), BUSTUB_PAGE_SIZE);
+      }
+      ios.push_back(disk_scheduler_->ScheduleWrite(dirty[begin].first, data.get(), end - begin));
+      buffers.push_back(std::move(data));
+    }
+    begin = end;
+  }
+  for (auto &io : ios) {
+    io.wait();
+  }
+  for (const auto &[page_id, data] : dirty) {
+    UnpinPage(page_id, false);
+  }
+  num_flushed_pages_.Add(dirty.size());
+  return dirty.size();
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  stats.num_shards_ = shards_.size();
+  stats.replacer_policy_ = replacer_policy_;
+  stats.hits_ = num_hits_.Load();
+  stats.misses_ = num_misses_.Load();
+  stats.evictions_ = num_evictions_.Load();
+  stats.dirty_victims_ = num_dirty_victims_.Load();
+  stats.flushed_pages_ = num_flushed_pages_.Load();
+  stats.pin_waits_ = num_pin_waits_.Load();
+  stats.no_evictable_frames_ = num_no_evictable_frames_.Load();
+  stats.fetch_miss_latency_ = fetch_miss_latency_.Snapshot();
+  stats.disk_read_latency_ = disk_scheduler_->GetReadLatency().Snapshot();
+  stats.disk_write_latency_ = disk_scheduler_->GetWriteLatency().Snapshot();
+  return stats;
+}
+
+void BufferPoolManager::ResetStats() {
+  num_hits_.Reset();
+  num_misses_.Reset();
+  num_evictions_.Reset();
+  num_dirty_victims_.Reset();
+  num_flushed_pages_.Reset();
+  num_pin_waits_.Reset();
+  num_no_evictable_frames_.Reset();
+  fetch_miss_latency_.Reset();
+  disk_scheduler_->GetReadLatency().Reset();
+  disk_scheduler_->GetWriteLatency().Reset();
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
-  auto p = FetchPage(page_id);
+auto BufferPoolManager::AllocatePage(Shard &shard) -> page_id_t {
+  return disk_manager_->AllocatePage(shards_.size(), shard.index_);
+}
+
+void BufferPoolManager::DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  auto p = FetchPage(page_id, access_type);
+  return {this, p};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  auto p = FetchPage(page_id, access_type);
+  p->RLatch();
+  return {this, p};
+}
+
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  auto p = FetchPage(page_id, access_type);
+  p->WLatch();
   return {this, p};
 }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  auto p = FetchPage(page_id);
+auto BufferPoolManager::FetchChildRead(const ReadPageGuard &parent, size_t slot, page_id_t child_id,
+                                       AccessType access_type) -> ReadPageGuard {
+  auto p = FetchChild(parent.guard_.page_, slot, child_id, access_type);
   p->RLatch();
   return {this, p};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  auto p = FetchPage(page_id);
+auto BufferPoolManager::FetchChildWrite(const WritePageGuard &parent, size_t slot, page_id_t child_id,
+                                        AccessType access_type) -> WritePageGuard {
+  auto p = FetchChild(parent.guard_.page_, slot, child_id, access_type);
   p->WLatch();
   return {this, p};
 }
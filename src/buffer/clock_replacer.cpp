@@ -12,18 +12,109 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <stdexcept>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_frames_(num_pages) {
+  size_t num_words = (num_pages + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  for (auto *bitmap : {&tracked_, &evictable_, &referenced_}) {
+    *bitmap = std::make_unique<std::atomic<uint64_t>[]>(num_words);
+    for (size_t i = 0; i < num_words; ++i) {
+      (*bitmap)[i].store(0);
+    }
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(num_frames_)) {
+    throw std::runtime_error("ClockReplacer: frame_id larger than replacer size");
+  }
+}
+
+auto ClockReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool {
+  if (num_frames_ == 0) {
+    return false;
+  }
+  // 转两圈: 第一圈清掉所有引用位, 第二圈一定能看到每个可驱逐的frame
+  for (size_t step = 0; step < 2 * num_frames_ && curr_size_.load() > 0; ++step) {
+    auto candidate = static_cast<frame_id_t>(hand_.fetch_add(1) % num_frames_);
+    if (!Test(evictable_, candidate)) {
+      continue;
+    }
+    if (Exchange(referenced_, candidate, false)) {
+      continue;
+    }
+    if (!can_evict(candidate)) {
+      continue;
+    }
+    // 并发的Evict可能选中了同一个frame, 清掉可驱逐位的那个才算赢
+    if (!Exchange(evictable_, candidate, false)) {
+      continue;
+    }
+    Exchange(tracked_, candidate, false);
+    --curr_size_;
+    *frame_id = candidate;
+    return true;
+  }
+  return false;
+}
+
+auto ClockReplacer::Victims(size_t n) -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> victims;
+  size_t hand = hand_.load();
+  // 先是指针转到时就会被驱逐的frame(引用位为0), 再是需要第二圈的frame
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < num_frames_ && victims.size() < n; ++i) {
+      auto candidate = static_cast<frame_id_t>((hand + i) % num_frames_);
+      if (Test(evictable_, candidate) && Test(referenced_, candidate) == referenced) {
+        victims.push_back(candidate);
+      }
+    }
+  }
+  return victims;
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  CheckFrame(frame_id);
+  bool was_tracked = Exchange(tracked_, frame_id, true);
+  if (access_type != AccessType::Scan) {
+    Exchange(referenced_, frame_id, true);
+  } else if (!was_tracked) {
+    Exchange(referenced_, frame_id, false);
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrame(frame_id);
+  if (!Test(tracked_, frame_id)) {
+    throw std::runtime_error("SetEvictable: no such frame");
+  }
+  if (Exchange(evictable_, frame_id, set_evictable) == set_evictable) {
+    return;
+  }
+  if (set_evictable) {
+    ++curr_size_;
+  } else {
+    --curr_size_;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  if (!Test(tracked_, frame_id)) {
+    return;
+  }
+  if (!Exchange(evictable_, frame_id, false)) {
+    throw std::runtime_error("Remove: remove a non-evictable node");
+  }
+  Exchange(tracked_, frame_id, false);
+  Exchange(referenced_, frame_id, false);
+  --curr_size_;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t { return curr_size_.load(); }
 
 }  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages) : size_(num_frames * BUSTUB_PAGE_SIZE) {
+  void *data = MAP_FAILED;
+  if (use_huge_pages) {
+    size_ = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages_ = data != MAP_FAILED;
+#endif
+  }
+  if (data == MAP_FAILED) {
+    // 普通映射按页对齐, 满足 O_DIRECT 的要求
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  }
+  if (data == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frame arena");
+  }
+#ifdef MADV_HUGEPAGE
+  if (use_huge_pages && !huge_pages_) {
+    // 没有预留的大页时退而使用透明大页, 失败也不影响正确性
+    madvise(data, size_, MADV_HUGEPAGE);
+  }
+#endif
+  data_ = static_cast<char *>(data);
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+void FrameArena::Release(size_t frame_id) {
+  if (huge_pages_) {
+    return;
+  }
+  // 匿名私有映射在 MADV_DONTNEED 之后再访问会得到全零的新页
+  madvise(GetFrameData(frame_id), BUSTUB_PAGE_SIZE, MADV_DONTNEED);
+}
+
+}  // namespace bustub
@@ -12,18 +12,98 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <stdexcept>
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : nodes_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  for (auto iter = lru_list_.begin(); iter != lru_list_.end(); ++iter) {
+    auto &node = nodes_[*iter];
+    if (!node.is_evictable_ || !can_evict(*iter)) {
+      continue;
+    }
+    *frame_id = *iter;
+    lru_list_.erase(iter);
+    node.is_tracked_ = false;
+    node.is_evictable_ = false;
+    --curr_size_;
+    return true;
+  }
+  return false;
+}
+
+auto LRUReplacer::Victims(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  std::vector<frame_id_t> victims;
+  for (auto iter = lru_list_.begin(); iter != lru_list_.end() && victims.size() < n; ++iter) {
+    if (nodes_[*iter].is_evictable_) {
+      victims.push_back(*iter);
+    }
+  }
+  return victims;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size())) {
+    throw std::runtime_error("RecordAccess: frame_id larger than replacer size");
+  }
+  auto &node = nodes_[frame_id];
+  if (access_type == AccessType::Scan) {
+    // 扫描不改变已有页面的位置, 新页面放在最先被驱逐的一端
+    if (!node.is_tracked_) {
+      node.pos_ = lru_list_.insert(lru_list_.begin(), frame_id);
+      node.is_tracked_ = true;
+    }
+    return;
+  }
+  if (node.is_tracked_) {
+    lru_list_.splice(lru_list_.end(), lru_list_, node.pos_);
+    return;
+  }
+  node.pos_ = lru_list_.insert(lru_list_.end(), frame_id);
+  node.is_tracked_ = true;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || !nodes_[frame_id].is_tracked_) {
+    throw std::runtime_error("SetEvictable: no such frame");
+  }
+  auto &node = nodes_[frame_id];
+  if (node.is_evictable_ != set_evictable) {
+    node.is_evictable_ = set_evictable;
+    if (set_evictable) {
+      ++curr_size_;
+    } else {
+      --curr_size_;
+    }
+  }
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || !nodes_[frame_id].is_tracked_) {
+    return;
+  }
+  auto &node = nodes_[frame_id];
+  if (!node.is_evictable_) {
+    throw std::runtime_error("Remove: remove a non-evictable node");
+  }
+  lru_list_.erase(node.pos_);
+  node.is_tracked_ = false;
+  node.is_evictable_ = false;
+  --curr_size_;
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  // 至少一半的槽位为空, 线性探测的链很短
+  size_t bits = 1;
+  while ((size_t{1} << bits) < 2 * max_entries) {
+    ++bits;
+  }
+  mask_ = (size_t{1} << bits) - 1;
+  shift_ = 64 - bits;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(mask_ + 1);
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+    uint64_t entry = slots_[i].load(std::memory_order_acquire);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (KeyOf(entry) == page_id) {
+      *frame_id = FrameOf(entry);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+    uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+    if (entry == EMPTY || KeyOf(entry) == page_id) {
+      size_ += entry == EMPTY ? 1 : 0;
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+auto PageTable::Erase(page_id_t page_id) -> bool {
+  size_t i = Home(page_id);
+  for (;; i = (i + 1) & mask_) {
+    uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (KeyOf(entry) == page_id) {
+      break;
+    }
+  }
+  // 把后面探测链上的条目前移填补空洞 (backward shift deletion), 不需要墓碑.
+  // 条目先复制到新位置再清除旧位置, 并发的 Find() 最多错过它, 不会读到错误的映射.
+  for (size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+    uint64_t entry = slots_[j].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    size_t home = Home(KeyOf(entry));
+    // 只有 home 不在 (i, j] 区间内的条目才能移到 i
+    bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+    if (movable) {
+      slots_[i].store(entry, std::memory_order_release);
+      i = j;
+    }
+  }
+  slots_[i].store(EMPTY, std::memory_order_release);
+  --size_;
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  switch (policy) {
+    case ReplacerPolicy::LRUK:
+      return std::make_unique<LRUKReplacer>(num_frames, k);
+    case ReplacerPolicy::LRU:
+      return std::make_unique<LRUReplacer>(num_frames);
+    case ReplacerPolicy::Clock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerPolicy::TwoQ:
+      return std::make_unique<TwoQueueReplacer>(num_frames);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ARCReplacer>(num_frames);
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+auto ParseReplacerPolicy(const std::string &name) -> ReplacerPolicy {
+  for (auto policy :
+       {ReplacerPolicy::LRUK, ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    if (ReplacerPolicyToString(policy) == name) {
+      return policy;
+    }
+  }
+  throw Exception("unknown replacer policy " + name);
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRUK:
+      return "lru-k";
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::Clock:
+      return "clock";
+    case ReplacerPolicy::TwoQ:
+      return "2q";
+    case ReplacerPolicy::ARC:
+      return "arc";
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+}  // namespace bustub
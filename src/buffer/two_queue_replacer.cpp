@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : nodes_(num_frames),
+      in_capacity_(std::max<size_t>(num_frames / 4, 1)),
+      ghost_capacity_(std::max<size_t>(num_frames / 2, 1)) {}
+
+auto TwoQueueReplacer::EvictionOrder() -> std::vector<std::list<frame_id_t> *> {
+  // A1in超出Kin时先从A1in驱逐, 否则从Am驱逐; 首选的队列里没有可驱逐的frame时再看另一个
+  if (in_queue_.size() > in_capacity_) {
+    return {&in_queue_, &main_queue_};
+  }
+  return {&main_queue_, &in_queue_};
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  for (auto *queue : EvictionOrder()) {
+    for (auto iter = queue->begin(); iter != queue->end(); ++iter) {
+      auto &node = nodes_[*iter];
+      if (!node.is_evictable_ || !can_evict(*iter)) {
+        continue;
+      }
+      if (queue == &in_queue_ && node.page_id_ != INVALID_PAGE_ID) {
+        Remember(node.page_id_);
+      }
+      *frame_id = *iter;
+      queue->erase(iter);
+      node = Node{};
+      --curr_size_;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto TwoQueueReplacer::Victims(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  std::vector<frame_id_t> victims;
+  for (auto *queue : EvictionOrder()) {
+    for (auto iter = queue->begin(); iter != queue->end() && victims.size() < n; ++iter) {
+      if (nodes_[*iter].is_evictable_) {
+        victims.push_back(*iter);
+      }
+    }
+  }
+  return victims;
+}
+
+void TwoQueueReplacer::Remember(page_id_t page_id) {
+  if (ghosts_.count(page_id) != 0) {
+    return;
+  }
+  if (ghost_queue_.size() >= ghost_capacity_) {
+    ghosts_.erase(ghost_queue_.front());
+    ghost_queue_.pop_front();
+  }
+  ghosts_[page_id] = ghost_queue_.insert(ghost_queue_.end(), page_id);
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size())) {
+    throw std::runtime_error("RecordAccess: frame_id larger than replacer size");
+  }
+  auto &node = nodes_[frame_id];
+  if (node.queue_ == Queue::Main) {
+    if (access_type != AccessType::Scan) {
+      main_queue_.splice(main_queue_.end(), main_queue_, node.pos_);
+    }
+    return;
+  }
+  if (node.queue_ == Queue::In) {
+    // A1in中的重复访问视为相关访问, 不提升
+    return;
+  }
+  node.page_id_ = page_id;
+  bool remembered = false;
+  if (page_id != INVALID_PAGE_ID) {
+    auto ghost = ghosts_.find(page_id);
+    if (ghost != ghosts_.end()) {
+      remembered = true;
+      ghost_queue_.erase(ghost->second);
+      ghosts_.erase(ghost);
+    }
+  }
+  if (remembered && access_type != AccessType::Scan) {
+    node.queue_ = Queue::Main;
+    node.pos_ = main_queue_.insert(main_queue_.end(), frame_id);
+  } else {
+    node.queue_ = Queue::In;
+    node.pos_ = in_queue_.insert(in_queue_.end(), frame_id);
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || nodes_[frame_id].queue_ == Queue::None) {
+    throw std::runtime_error("SetEvictable: no such frame");
+  }
+  auto &node = nodes_[frame_id];
+  if (node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    ++curr_size_;
+  } else {
+    --curr_size_;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(nodes_.size()) || nodes_[frame_id].queue_ == Queue::None) {
+    return;
+  }
+  auto &node = nodes_[frame_id];
+  if (!node.is_evictable_) {
+    throw std::runtime_error("Remove: remove a non-evictable node");
+  }
+  (node.queue_ == Queue::In ? in_queue_ : main_queue_).erase(node.pos_);
+  node = Node{};
+  --curr_size_;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lkgd(latch_);
+  return curr_size_;
+}
+
+}  // namespace bustub
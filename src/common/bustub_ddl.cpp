@@ -36,10 +36,27 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/key_encoder.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+
+/** The largest key size an index is instantiated with. */
+constexpr size_t MAX_INDEX_KEY_SIZE = 64;
+
+/** Create a B+ tree index whose keys are KeySize bytes. */
+template <size_t KeySize>
+auto CreateIndex(Catalog *catalog, Transaction *txn, const IndexStatement &stmt, const Schema &key_schema,
+                 const std::vector<uint32_t> &col_ids) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(
+      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, KeySize,
+      HashFunction<GenericKey<KeySize>>{});
+}
+
+}  // namespace
+
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
   auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
@@ -56,25 +73,27 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   for (const auto &col : stmt.cols_) {
     auto idx = stmt.table_->schema_.GetColIdx(col->col_name_.back());
     col_ids.push_back(idx);
-    if (stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-      throw NotImplementedException("only support creating index on integer column");
-    }
   }
   auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
 
-  // TODO(spring2023): If you want to support composite index key for leaderboard optimization, remove this assertion
-  // and create index with different key type that can hold multiple keys based on number of index columns.
-  //
-  // You can also create clustered index that directly stores value inside the index by modifying the value type.
-
-  if (col_ids.empty() || col_ids.size() > 2) {
-    throw NotImplementedException("only support creating index with exactly one or two columns");
+  // 按最长的key选key的大小, 整数和短字符串的key不用占64字节的槽位, 一页放得下更多key
+  auto key_size = KeyEncoder::MaxSize(key_schema);
+  if (col_ids.empty() || key_size > MAX_INDEX_KEY_SIZE) {
+    throw NotImplementedException(
+        fmt::format("only support creating index on one or more columns of at most {} bytes", MAX_INDEX_KEY_SIZE));
   }
 
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  IndexInfo *info;
+  if (key_size <= 8) {
+    info = CreateIndex<8>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 16) {
+    info = CreateIndex<16>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 32) {
+    info = CreateIndex<32>(catalog_, txn, stmt, key_schema, col_ids);
+  } else {
+    info = CreateIndex<64>(catalog_, txn, stmt, key_schema, col_ids);
+  }
   l.unlock();
 
   if (info == nullptr) {
@@ -128,11 +147,27 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
   auto content = GetSessionVariable(stmt.variable_);
+  if (stmt.variable_ == "buffer_pool_size" && buffer_pool_manager_ != nullptr) {
+    content = std::to_string(buffer_pool_manager_->GetPoolSize());
+  }
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == "buffer_pool_size") {
+    if (buffer_pool_manager_ == nullptr) {
+      throw Exception("buffer pool is not available");
+    }
+    size_t pool_size = 0;
+    try {
+      pool_size = std::stoul(stmt.value_);
+    } catch (std::logic_error &e) {
+      throw Exception(fmt::format("invalid buffer pool size: {}", stmt.value_));
+    }
+    // Pages pinned by running queries stay in their frames and are released later, so this does not block.
+    buffer_pool_manager_->Resize(pool_size);
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
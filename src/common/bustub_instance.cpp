@@ -42,7 +42,7 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn, bool is_modify) -> st
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_, is_modify);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, BufferPoolOptions options) {
   enable_logging = false;
 
   // Storage related.
@@ -51,10 +51,11 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(options.pool_size_, disk_manager_, LRUK_REPLACER_K, log_manager_, 1,
+                                                 options.use_huge_pages_, options.replacer_policy_,
+                                                 options.max_pool_size_);
+    buffer_pool_manager_->RunFlushThread();
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << '\n';
     buffer_pool_manager_ = nullptr;
@@ -82,7 +83,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(BufferPoolOptions options) {
   enable_logging = false;
 
   // Storage related.
@@ -91,10 +92,11 @@ BustubInstance::BustubInstance() {
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(options.pool_size_, disk_manager_, LRUK_REPLACER_K, log_manager_, 1,
+                                                 options.use_huge_pages_, options.replacer_policy_,
+                                                 options.max_pool_size_);
+    buffer_pool_manager_->RunFlushThread();
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << '\n';
     buffer_pool_manager_ = nullptr;
@@ -163,6 +165,47 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBpmStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  auto stats = buffer_pool_manager_->GetStats();
+  auto latency = [](const HistogramSnapshot &histogram) {
+    return fmt::format("count={} mean={:.1f}us p50={:.1f}us p99={:.1f}us p999={:.1f}us max={:.1f}us", histogram.count_,
+                       histogram.Mean() / 1000, histogram.Percentile(0.5) / 1000.0,
+                       histogram.Percentile(0.99) / 1000.0, histogram.Percentile(0.999) / 1000.0,
+                       histogram.max_ / 1000.0);
+  };
+  std::vector<std::pair<std::string, std::string>> rows = {
+      {"pool_size", fmt::format("{}", stats.pool_size_)},
+      {"num_shards", fmt::format("{}", stats.num_shards_)},
+      {"replacer", ReplacerPolicyToString(stats.replacer_policy_)},
+      {"hits", fmt::format("{}", stats.hits_)},
+      {"misses", fmt::format("{}", stats.misses_)},
+      {"hit_rate", fmt::format("{:.4f}", stats.HitRate())},
+      {"evictions", fmt::format("{}", stats.evictions_)},
+      {"dirty_victims", fmt::format("{}", stats.dirty_victims_)},
+      {"flushed_pages", fmt::format("{}", stats.flushed_pages_)},
+      {"pin_waits", fmt::format("{}", stats.pin_waits_)},
+      {"no_evictable_frames", fmt::format("{}", stats.no_evictable_frames_)},
+      {"fetch_miss_latency", latency(stats.fetch_miss_latency_)},
+      {"disk_read_latency", latency(stats.disk_read_latency_)},
+      {"disk_write_latency", latency(stats.disk_write_latency_)},
+  };
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("metric");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[metric, value] : rows) {
+    writer.BeginRow();
+    writer.WriteCell(metric);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +219,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpm_stats: show buffer pool counters and latencies, `\bpm_stats reset` clears them
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +260,17 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpm_stats") {
+      CmdDisplayBpmStats(writer);
+      return true;
+    }
+    if (sql == "\\bpm_stats reset") {
+      if (buffer_pool_manager_ == nullptr) {
+        throw Exception("buffer pool manager is not available");
+      }
+      buffer_pool_manager_->ResetStats();
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
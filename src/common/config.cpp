@@ -20,4 +20,6 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<size_t> scan_prefetch_window(4);
+
 }  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics.cpp
+//
+// Identification: src/common/util/metrics.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bustub {
+
+auto StripedCounter::StripeIndex() -> size_t {
+  static std::atomic<size_t> next_stripe{0};
+  thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % NUM_STRIPES;
+  return stripe;
+}
+
+auto StripedCounter::Load() const -> uint64_t {
+  uint64_t sum = 0;
+  for (const auto &stripe : stripes_) {
+    sum += stripe.value_.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+void StripedCounter::Reset() {
+  for (auto &stripe : stripes_) {
+    stripe.value_.store(0, std::memory_order_relaxed);
+  }
+}
+
+auto LatencyHistogram::BucketOf(uint64_t value) -> size_t {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  // 最高位决定是哪个2的幂, 其后SUB_BUCKET_BITS位决定是其中哪个线性小桶
+  auto shift = static_cast<size_t>(63 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+  auto sub = static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+  return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+auto LatencyHistogram::BucketLowerBound(size_t bucket) -> uint64_t {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = bucket / SUB_BUCKETS - 1;
+  return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+auto LatencyHistogram::BucketUpperBound(size_t bucket) -> uint64_t {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = bucket / SUB_BUCKETS - 1;
+  return BucketLowerBound(bucket) + ((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t nanos) {
+  buckets_[BucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(nanos, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (nanos > max && !max_.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+  }
+}
+
+auto LatencyHistogram::Snapshot() const -> HistogramSnapshot {
+  HistogramSnapshot snapshot;
+  snapshot.buckets_.resize(NUM_BUCKETS);
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    // 以桶里的计数为准, 这样并发记录时分位数也和count_一致
+    snapshot.count_ += snapshot.buckets_[i];
+  }
+  snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+  snapshot.max_ = max_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+auto HistogramSnapshot::Percentile(double q) const -> uint64_t {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count_)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min(LatencyHistogram::BucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+}  // namespace bustub
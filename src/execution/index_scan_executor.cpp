@@ -12,7 +12,9 @@
 #include "execution/executors/index_scan_executor.h"
 #include <iostream>
 #include "common/config.h"
-#include "storage/index/b_plus_tree_index.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -22,31 +24,63 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
 void IndexScanExecutor::Init() {
   catalog_ = exec_ctx_->GetCatalog();
   index_info_ = catalog_->GetIndex(plan_->index_oid_);
-  index_ = reinterpret_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get());
-  iter_ = index_->GetBeginIterator();
+  table_info_ = catalog_->GetTable(index_info_->table_name_);
+  auto txn = exec_ctx_->GetTransaction();
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !txn->IsTableSharedLocked(table_info_->oid_) &&
+      !txn->IsTableIntentionSharedLocked(table_info_->oid_) && !txn->IsTableExclusiveLocked(table_info_->oid_) &&
+      !txn->IsTableIntentionExclusiveLocked(table_info_->oid_) &&
+      !txn->IsTableSharedIntentionExclusiveLocked(table_info_->oid_)) {
+    exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::INTENTION_SHARED, table_info_->oid_);
+  }
+  // 上下界编码成和索引key一样的格式, 比较的时候只比前缀
+  std::vector<char> lower_key;
+  for (const auto &value : plan_->lower_bound_) {
+    KeyEncoder::Encode(value, &lower_key);
+  }
+  std::vector<char> upper_key;
+  for (const auto &value : plan_->upper_bound_) {
+    KeyEncoder::Encode(value, &upper_key);
+  }
+  // 先把范围内的rid都收集起来, 扫索引的时候拿着叶子的读锁, 不能一边拿着一边等行锁
+  rids_.clear();
+  cursor_ = 0;
+  index_info_->index_->ScanRange(lower_key, plan_->lower_inclusive_, upper_key, plan_->upper_inclusive_, &rids_, txn);
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  TupleMeta meta;
-  while (true) {
-    if (iter_.IsEnd()) {
-      return false;
+  auto txn = exec_ctx_->GetTransaction();
+  while (cursor_ < rids_.size()) {
+    *rid = rids_[cursor_++];
+    bool locked = txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+                  !txn->IsRowExclusiveLocked(table_info_->oid_, *rid);
+    if (locked) {
+      exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, table_info_->oid_, *rid);
     }
-    *rid = (*iter_).second;
-    if (rid->GetPageId() == INVALID_PAGE_ID) {
-      ++iter_;
+    // 元数据和tuple一次取出来
+    auto [meta, tp] = table_info_->table_->GetTuple(*rid);
+    if (meta.is_deleted_) {
+      if (locked && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+        exec_ctx_->GetLockManager()->UnlockRow(txn, table_info_->oid_, *rid, true);
+      }
       continue;
     }
-    meta = catalog_->GetTable(index_info_->table_name_)->table_->GetTupleMeta(*rid);
-    if (meta.is_deleted_) {
-      ++iter_;
-    } else {
-      break;
+    if (plan_->filter_predicate_ != nullptr) {
+      auto result = plan_->filter_predicate_->Evaluate(&tp, GetOutputSchema());
+      if (result.IsNull() || !result.GetAs<bool>()) {
+        // 和seqscan一样, 不满足条件的行不用一直锁着
+        if (locked) {
+          exec_ctx_->GetLockManager()->UnlockRow(txn, table_info_->oid_, *rid, true);
+        }
+        continue;
+      }
+    }
+    if (locked && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      exec_ctx_->GetLockManager()->UnlockRow(txn, table_info_->oid_, *rid);
     }
+    *tuple = std::move(tp);
+    return true;
   }
-  *tuple = catalog_->GetTable(index_info_->table_name_)->table_->GetTuple(*rid).second;
-  ++iter_;
-  return true;
+  return false;
 }
 
 }  // namespace bustub
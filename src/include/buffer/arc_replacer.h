@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident frames are split into T1, pages seen once recently, and T2, pages seen at least twice; both are LRU lists.
+ * The ids of pages evicted from T1 and T2 are remembered in the ghost lists B1 and B2. A miss on a page in B1 means T1
+ * was too small and grows its target size p, a miss on a page in B2 shrinks it. The victim comes from T1 while T1 is
+ * larger than p, and from T2 otherwise. Together the ghost lists remember at most as many pages as there are frames.
+ * A scan access never moves a page to T2 and never adapts p.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  using Replacer::Evict;
+  using Replacer::RecordAccess;
+
+  /**
+   * Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool override;
+
+  auto Victims(size_t n) -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1 */
+  auto GetTargetRecentSize() -> size_t;
+
+ private:
+  enum class Queue { None, Recent, Frequent };
+
+  struct Node {
+    Queue queue_{Queue::None};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  struct Ghost {
+    Queue queue_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  /** @return the lists in the order they are evicted from */
+  auto EvictionOrder() -> std::vector<std::list<frame_id_t> *>;
+
+  /** Add the id of a page evicted from queue to its ghost list and trim the ghost lists. */
+  void Remember(Queue queue, page_id_t page_id);
+
+  auto GhostsOf(Queue queue) -> std::list<page_id_t> & {
+    return queue == Queue::Recent ? recent_ghosts_ : frequent_ghosts_;
+  }
+
+  /** Per-frame state, indexed by frame id. */
+  std::vector<Node> nodes_;
+  /** T1 and T2, least recently used first. */
+  std::list<frame_id_t> recent_;
+  std::list<frame_id_t> frequent_;
+  /** B1 and B2, oldest first. */
+  std::list<page_id_t> recent_ghosts_;
+  std::list<page_id_t> frequent_ghosts_;
+  std::unordered_map<page_id_t, Ghost> ghosts_;
+  /** c of the paper. */
+  size_t capacity_;
+  /** p of the paper, the target size of T1. */
+  size_t target_recent_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,22 +12,107 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
 #include <list>
 #include <memory>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/util/metrics.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** A snapshot of the counters and latency histograms of a buffer pool, see BufferPoolManager::GetStats(). */
+struct BufferPoolStats {
+  /** Size (number of frames) of the buffer pool. */
+  size_t pool_size_{0};
+  /** Number of shards the buffer pool is split into. */
+  size_t num_shards_{0};
+  /** The replacement policy of the buffer pool. */
+  ReplacerPolicy replacer_policy_{ReplacerPolicy::LRUK};
+  /** Number of page fetches that found the page in the buffer pool, including optimistic ones. */
+  uint64_t hits_{0};
+  /** Number of page fetches that had to read the page. */
+  uint64_t misses_{0};
+  /** Number of pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Number of evicted pages that were dirty and so written back in the foreground. */
+  uint64_t dirty_victims_{0};
+  /** Number of dirty pages written back by FlushDirtyVictims() before they were evicted. */
+  uint64_t flushed_pages_{0};
+  /** Number of times a thread waited for a frame: a hit on a page still being read, or a free frame still pinned by a
+   * lock-free reader that is about to let go of it. */
+  uint64_t pin_waits_{0};
+  /** Number of times no frame could be found because all frames of a shard were pinned. */
+  uint64_t no_evictable_frames_{0};
+  /** Duration of page fetches that missed, from the miss until the page was read. */
+  HistogramSnapshot fetch_miss_latency_;
+  /** Duration of page reads and writes in the disk manager. */
+  HistogramSnapshot disk_read_latency_;
+  HistogramSnapshot disk_write_latency_;
+
+  /** @return the fraction of page fetches that were hits, 0 if there were none */
+  auto HitRate() const -> double {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * All disk I/O goes through a DiskScheduler. The pool latch only protects the book-keeping (page table, free list,
+ * replacer and frame metadata); it is released while a page is read from or written to disk, so a cache miss does not
+ * stall threads that hit in the pool. A frame whose I/O is still in flight is already visible in the page table and
+ * pinned; threads that hit on it wait for the frame's pending I/O to finish before using the page.
+ *
+ * An optional flush thread cleans dirty, unpinned pages that are about to be evicted in the background, so NewPage and
+ * FetchPage rarely have to write back a dirty victim themselves.
+ *
+ * The pool can be split into several shards. Each shard owns a contiguous range of frames and has its own latch, page
+ * table, free list and replacer; page `p` always lives in shard `p % num_shards`, so operations on pages of different
+ * shards never contend on the same latch.
+ *
+ * Hits on resident pages take no latch at all: FetchPage() looks the page up in the shard's concurrent PageTable,
+ * pins the frame by atomically incrementing its pin count and then validates that the frame still holds the page.
+ * The access is queued in a small per-shard buffer and handed to the replacer the next time the shard latch is taken.
+ * Only misses, evictions and page creation/deletion take the shard latch. Because of this the replacer only decides
+ * the eviction order: every resident frame is evictable in the replacer, and an evictor claims its victim by swapping
+ * a pin count of 0 for -1, skipping pinned frames. The replacement policy (LRU-K, LRU, CLOCK, 2Q or ARC) is chosen
+ * when the pool is created, see MakeReplacer().
+ *
+ * Index traversals can skip the page table altogether with FetchChildRead()/FetchChildWrite(): every frame can keep a
+ * swip (a hint of the frame holding the child) per child slot of the page it holds, in the spirit of LeanStore's pointer
+ * swizzling. The page itself is left untouched and a swip is only a hint: it is validated by the same pin-then-check
+ * as a lock-free hit, so a frame's swips are simply dropped when it is evicted, and no parent has to be found and
+ * fixed up when a child is evicted.
+ *
+ * Read-mostly accesses can use FetchPageOptimistic(), which pins and latches nothing: every page has a version that
+ * its writers bump, and a frame's version also changes when the frame is claimed for another page, so a reader can
+ * validate afterwards that what it read was consistent.
+ *
+ * The data of all frames comes from one page-aligned FrameArena, optionally backed by huge pages, while the frame
+ * metadata (the Page objects) lives in a separate array of cache-line aligned entries.
+ *
+ * The pool can be resized at runtime with Resize(), up to the capacity it was created with. The arena and the frame
+ * metadata are allocated for the whole capacity up front, so frames never move and a Page pointer stays valid; frames
+ * beyond the pool size are only reserved address space. Every shard uses a prefix of its frame range. Growing hands the
+ * next frames to the free lists; shrinking retires the frames past the new size: free and unpinned frames are released
+ * right away, pinned frames keep serving their page until they are unpinned and are released by the next miss in
+ * their shard.
  */
 class BufferPoolManager {
  public:
@@ -37,21 +122,85 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_shards number of independent shards the frames are split into
+   * @param use_huge_pages back the frame arena with huge pages
+   * @param replacer_policy the replacement policy of every shard
+   * @param max_pool_size the largest size Resize() can grow the pool to, 0 for pool_size
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_shards = 1, bool use_huge_pages = false,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK, size_t max_pool_size = 0);
 
   /**
-   * @brief Destroy an existing BufferPoolManager.
+   * @brief Destroy an existing BufferPoolManager. Stops the flush thread if it is running.
    */
   ~BufferPoolManager();
 
+  /**
+   * @brief Start the background flush thread. Every interval it runs FlushDirtyVictims().
+   * @param interval time between two flush rounds
+   */
+  void RunFlushThread(std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+  /** @brief Stop the background flush thread and wait for it to exit. Does nothing if it is not running. */
+  void StopFlushThread();
+
+  /**
+   * @brief Write back the dirty pages among the next victims of each shard's replacer.
+   *
+   * Up to a quarter of the frames of each shard are looked at, in the order they would be evicted. The dirty pages are
+   * copied and pinned while their write is in flight. Runs of consecutive page ids are coalesced into a single write.
+   *
+   * @return number of pages written
+   */
+  auto FlushDirtyVictims() -> size_t;
+
+  /** @brief Return the number of pages written by FlushDirtyVictims(). */
+  auto GetNumFlushedPages() -> size_t { return num_flushed_pages_.Load(); }
+
+  /** @brief Return how often a dirty page was picked as victim, so its write-back was started in the foreground. */
+  auto GetNumDirtyVictims() -> size_t { return num_dirty_victims_.Load(); }
+
+  /** @brief Return the number of FetchPage() calls that did not find the page in the buffer pool. */
+  auto GetNumMisses() -> size_t { return num_misses_.Load(); }
+
+  /**
+   * @brief Return a snapshot of the buffer pool's counters and latency histograms, counted since the pool was created
+   * or since the last ResetStats(). The counters are read one after another while other threads keep counting, so they
+   * need not add up exactly.
+   */
+  auto GetStats() -> BufferPoolStats;
+
+  /** @brief Set all counters and latency histograms of GetStats() to 0. */
+  void ResetStats();
+
+  /** @brief Return the replacement policy of the buffer pool. */
+  auto GetReplacerPolicy() -> ReplacerPolicy { return replacer_policy_; }
+
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t { return pool_size_; }
 
+  /** @brief Return the largest size the buffer pool can be resized to. */
+  auto GetPoolCapacity() -> size_t { return capacity_; }
+
+  /**
+   * @brief Grow or shrink the buffer pool while it is in use.
+   *
+   * The new frames of a shard are added to its free list. When shrinking, dirty pages in the retired frames are written
+   * back like those of evicted frames, and the memory of a retired frame is returned to the operating system. Pages
+   * that are pinned stay in their frame until they are unpinned. Throws an Exception if pool_size is smaller than the
+   * number of shards or larger than the capacity of the pool.
+   *
+   * @param pool_size the new number of frames
+   */
+  void Resize(size_t pool_size);
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of shards the buffer pool is split into. */
+  auto GetNumShards() -> size_t { return shards_.size(); }
+
   /**
    * TODO(P1): Add implementation
    *
@@ -99,7 +248,8 @@ class BufferPoolManager {
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page. Pages fetched with AccessType::Scan do not displace pages fetched
+   * for point lookups, see the replacer of the chosen policy.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
@@ -115,11 +265,63 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, see FetchPage()
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch the child of a page through the swip of the parent's child slot, i.e. without a page table lookup if
+   * the child is still in the frame it was found in last time.
+   *
+   * Behaves like FetchPageRead()/FetchPageWrite() of child_id. The caller must hold the parent guard (and so a pin and
+   * a latch on the parent) until this returns. The slot only selects the swip; a swip left behind by another child
+   * (e.g. after entries were moved by a split) just misses and is overwritten.
+   *
+   * @param parent guard of the page that points to the child
+   * @param slot index of the child pointer in the parent
+   * @param child_id id of the child page, as stored in the parent
+   * @param access_type type of access to the page, see FetchPage()
+   * @return PageGuard holding the child page
+   */
+  auto FetchChildRead(const ReadPageGuard &parent, size_t slot, page_id_t child_id,
+                      AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchChildWrite(const WritePageGuard &parent, size_t slot, page_id_t child_id,
+                       AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for an optimistic read, see OptimisticReadGuard. Neither a pin nor a latch is held afterwards.
+   *
+   * A resident page is neither pinned nor latched at all. A page that is not resident is read in first, and a page that
+   * is write-latched is waited for; the page is only pinned (and read-latched) for that wait.
+   *
+   * @param page_id id of the page to fetch
+   * @param access_type type of access to the page, see FetchPage()
+   * @return guard of the page, holding no page if the page cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> OptimisticReadGuard;
+
+  /**
+   * @brief FetchPageOptimistic() of a child page through the swip of the parent's child slot, see FetchChildRead().
+   * The parent is not pinned, but a validated guard on it is expected.
+   */
+  auto FetchChildOptimistic(const OptimisticReadGuard &parent, size_t slot, page_id_t child_id,
+                            AccessType access_type = AccessType::Unknown) -> OptimisticReadGuard;
+
+  /**
+   * @brief Start reading a page into the buffer pool without waiting for it and without pinning it for the caller.
+   *
+   * The frame is only pinned while the read is in flight; afterwards it is an evictable frame with a single scan
+   * access, so a later FetchPage() of the page is a hit and pages that are prefetched but never used are the first to be
+   * evicted. At most a quarter of the frames of a shard are used for reads in flight. A page that is already in the
+   * pool, or was just evicted and is still being written back, is not prefetched.
+   *
+   * @param page_id id of page to be prefetched
+   * @return true if a read was issued for the page, false otherwise
+   */
+  auto PrefetchPage(page_id_t page_id) -> bool;
 
   /**
    * TODO(P1): Add implementation
@@ -160,7 +362,7 @@ class BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
+   * @brief Delete a page from the buffer pool and deallocate it on disk, so that its page id can be reused. If the
    * page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
@@ -173,42 +375,207 @@ class BufferPoolManager {
   auto DeletePage(page_id_t page_id) -> bool;
 
  private:
+  /** A dirty page that was evicted and is being written back from a private copy of its data. */
+  struct WriteBack {
+    std::shared_future<bool> io_;
+    std::unique_ptr<char[]> data_;
+  };
+
+  /** One partition of the buffer pool. Frames [frame_begin_, frame_begin_ + capacity_) of pages_ belong to it. */
+  struct Shard {
+    /** Global id of the first frame of this shard. The replacer works on frame ids relative to it. */
+    frame_id_t frame_begin_;
+    /**
+     * Number of frames in use: frames [frame_begin_, frame_begin_ + size_). Changed by Resize() under latch_, read by
+     * the lock-free paths to skip frames that are being retired.
+     */
+    std::atomic<size_t> size_;
+    /** Number of frames the shard can grow to. */
+    size_t capacity_;
+    /** Index of this shard in shards_. The shard allocates the page ids p with p % num_shards == index_. */
+    size_t index_;
+    /** Number of lock-free hits that can be queued for the replacer. */
+    static constexpr size_t ACCESS_BUFFER_SIZE = 64;
+
+    /** Page table for keeping track of the pages in this shard. Written under latch_, read without it. */
+    std::unique_ptr<PageTable> page_table_;
+    /** Replacer to find unpinned pages for replacement. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Write-backs of evicted dirty pages that may still be in flight. A miss on such a page is served from the copy. */
+    std::unordered_map<page_id_t, WriteBack> write_back_;
+    /** Frames with a prefetch read that may still be in flight. Each of them holds one pin until its read is done. */
+    std::vector<frame_id_t> prefetching_;
+    /** Frames past size_ that still hold a page, because it was pinned when the shard shrank. See RetireFrames(). */
+    std::vector<frame_id_t> draining_;
+    /** Accesses of lock-free hits not yet recorded in the replacer, see RecordHit(). 0 marks an empty slot. */
+    std::array<std::atomic<uint64_t>, ACCESS_BUFFER_SIZE> access_buffer_{};
+    /** Next free slot of access_buffer_. May run past its end, then further hits are dropped. */
+    std::atomic<size_t> access_head_{0};
+    /** This latch serializes changes to the shard's page table, free list, replacer, write-backs, prefetches and the
+     * metadata and frame_io_ of its frames. It is never held while waiting for disk I/O. */
+    std::mutex latch_;
+  };
+
+  /** Number of swips of a frame: one per child of an internal B+ tree page with the smallest (4-byte) keys. */
+  static constexpr size_t SWIPS_PER_FRAME = BUSTUB_PAGE_SIZE / (sizeof(int32_t) + sizeof(page_id_t));
+  /** Value of a swip that points to no frame. */
+  static constexpr frame_id_t NO_SWIP = -1;
+
   /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  std::atomic<size_t> pool_size_;
+  /** Number of frames allocated (or reserved) for the buffer pool. */
+  const size_t capacity_;
+  const ReplacerPolicy replacer_policy_;
 
-  /** Array of buffer pool pages. */
+  /** Memory of all frames. */
+  std::unique_ptr<FrameArena> arena_;
+  /** Array of buffer pool pages. The frame id of a page is its index in this array. */
   Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the disk manager. Page ids are allocated from its free space map. */
+  DiskManager *disk_manager_;
+  /** Pointer to the disk scheduler. All page reads and writes are issued through it. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** Completion of the last read issued on each frame, indexed by frame id. Invalid if the frame was never read. */
+  std::vector<std::shared_future<bool>> frame_io_;
+  /** The shards of the buffer pool. */
+  std::vector<std::unique_ptr<Shard>> shards_;
+  /** The shard NewPage tries first. Advanced round-robin so that new pages are spread over all shards. */
+  std::atomic<size_t> next_shard_ = 0;
+
+  /** Counters of GetStats(). Hits are counted on the lock-free path, so every counter is striped over threads. */
+  StripedCounter num_hits_;
+  StripedCounter num_misses_;
+  StripedCounter num_evictions_;
+  StripedCounter num_dirty_victims_;
+  StripedCounter num_flushed_pages_;
+  StripedCounter num_pin_waits_;
+  StripedCounter num_no_evictable_frames_;
+  /** Duration of FetchPage() misses. */
+  LatencyHistogram fetch_miss_latency_;
+  /** Serializes Resize() calls. */
+  std::mutex resize_latch_;
+  /** Serializes FlushDirtyVictims() and FlushPage(), so an older copy of a page is never written after a newer one. */
+  std::mutex flush_latch_;
+  /** The background flush thread, if running. */
+  std::thread flush_thread_;
+  /** Set to stop the flush thread. Protected by flush_thread_latch_. */
+  bool flush_thread_stop_{false};
+  std::mutex flush_thread_latch_;
+  std::condition_variable flush_thread_cv_;
+
+  /** @brief Return the shard a page belongs to. */
+  auto GetShard(page_id_t page_id) -> Shard & { return *shards_[page_id % shards_.size()]; }
+
+  /** @brief Create a new page in the given shard. */
+  auto NewPageInShard(Shard &shard, page_id_t *page_id) -> Page *;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, preferring the lowest free page id of the shard.
+   * @param shard the shard the page will belong to
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(Shard &shard) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that AllocatePage() can hand out its id again. No write of the page may still
+   * be in flight.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @brief Take a frame of the shard from its free list, or evict one from its replacer. Caller should hold the shard
+   * latch.
+   *
+   * If the victim frame holds a page, the page is removed from the page table. If it is dirty, its data is copied and
+   * the copy is scheduled for write-back, so the frame can be reused right away.
+   *
+   * @param shard the shard to take the frame from
+   * @param[out] frame_id the acquired (global) frame id
+   * @return false if all frames of the shard are pinned
+   */
+  auto AcquireFrame(Shard &shard, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Take a page out of a frame whose pin count the caller swapped from 0 to -1: remove it from the page table
+   * and start the write-back if it is dirty. Caller should hold the shard latch.
+   */
+  void EvictFrame(Shard &shard, frame_id_t frame_id);
+
+  /**
+   * @brief Release the frames of the shard that are past its size and no longer pinned, see Resize(). A released frame
+   * keeps a pin count of -1 and holds no page until the shard grows again. Caller should hold the shard latch.
+   */
+  void RetireFrames(Shard &shard);
+
+  /** @brief Set the number of frames of a shard, see Resize(). Caller should hold the shard latch. */
+  void ResizeShard(Shard &shard, size_t size);
+
+  /**
+   * @brief Put a page into a frame returned by AcquireFrame(), pinned once and not loaded yet, and publish it in the
+   * page table and the replacer. Caller should hold the shard latch.
+   */
+  void InstallPage(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /**
+   * @brief Pin a frame without any latch, if it holds the page and the page is loaded.
+   * @return false if the frame is being evicted or retired, holds another page or is still being read; it is not
+   * pinned then
+   */
+  auto TryPin(Page *p, page_id_t page_id) -> bool;
+
+  /** @brief Drop one pin of a page and mark it dirty if needed. Lock-free. @return false if it was not pinned */
+  static auto Unpin(Page *p, bool is_dirty) -> bool;
+
+  /**
+   * @brief Queue the access of a lock-free hit for the replacer. If the queue is full it is drained right away when
+   * the shard latch is free, otherwise the access is dropped.
+   */
+  void RecordHit(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /**
+   * @brief Record the queued accesses of lock-free hits in the replacer, skipping frames that hold another page by now.
+   * Caller should hold the shard latch.
+   */
+  void DrainAccesses(Shard &shard);
+
+  /**
+   * @brief Fetch a child page, trying the frame its swip in the parent points to first. Updates the swip on a miss.
+   * @return nullptr if the child cannot be fetched, otherwise the pinned (but not latched) child
+   */
+  auto FetchChild(Page *parent, size_t slot, page_id_t child_id, AccessType access_type) -> Page *;
+
+  /**
+   * @brief Take an optimistic guard on a frame without pinning it, if it holds the page, the page is loaded and no
+   * writer holds its latch.
+   * @return false if the guard could not be taken
+   */
+  auto TryOptimistic(Page *p, page_id_t page_id, OptimisticReadGuard *guard) -> bool;
+
+  /** @brief Return true iff a frame is past the size of its shard, waiting to be released after a shrink. */
+  auto IsRetiring(Page *p, page_id_t page_id) -> bool {
+    Shard &shard = GetShard(page_id);
+    return static_cast<size_t>(p - pages_ - shard.frame_begin_) >= shard.size_.load(std::memory_order_relaxed);
   }
 
-  // TODO(student): You may add additional private members and helper functions
-  std::unordered_map<frame_id_t, Page *> frame_table_;
-  auto FrameToPage(frame_id_t id) -> Page * { return frame_table_.at(id); }
+  /** @brief Return the swip for a child slot of a frame, allocating the frame's swips on first use. */
+  static auto GetSwip(Page *parent, size_t slot) -> std::atomic<frame_id_t> &;
+
+  /** @brief Invalidate the swips of a frame. Caller should own the frame, i.e. hold its pin count at -1. */
+  static void ClearSwips(Page *p);
+
+  /** @brief Drop the pin of every prefetch of the shard whose read has finished. Caller should hold the shard latch. */
+  void ReapPrefetches(Shard &shard);
+
+  /** @brief Wait for a (possibly invalid) I/O future. Must be called without holding a shard latch. */
+  static void WaitForIo(const std::shared_future<bool> &io) {
+    if (io.valid()) {
+      io.wait();
+    }
+  }
 };
 }  // namespace bustub
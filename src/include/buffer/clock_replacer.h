@@ -12,8 +12,10 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,9 +25,18 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state of a frame is three bits in atomic bitmaps: tracked, evictable and referenced. An access only sets the
+ * referenced bit, and the clock hand is an atomic counter, so no operation takes a latch: a hit costs one fetch_or,
+ * and concurrent Evict() calls each advance the hand on their own. The hand clears the referenced bit of a frame it
+ * passes and evicts the first evictable frame whose bit is already clear. A scan access to a tracked frame is ignored,
+ * and a frame first seen by a scan starts with a clear referenced bit.
  */
 class ClockReplacer : public Replacer {
  public:
+  using Replacer::Evict;
+  using Replacer::RecordAccess;
+
   /**
    * Create a new ClockReplacer.
    * @param num_pages the maximum number of pages the ClockReplacer will be required to store
@@ -37,16 +48,45 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool override;
+
+  auto Victims(size_t n) -> std::vector<frame_id_t> override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  static constexpr size_t BITS_PER_WORD = 64;
+
+  /** @return the mask of frame_id in its bitmap word */
+  static auto Bit(frame_id_t frame_id) -> uint64_t { return uint64_t{1} << (frame_id % BITS_PER_WORD); }
+
+  static auto Test(const std::unique_ptr<std::atomic<uint64_t>[]> &bitmap, frame_id_t frame_id) -> bool {
+    return (bitmap[frame_id / BITS_PER_WORD].load() & Bit(frame_id)) != 0;
+  }
+
+  /** Set or clear a bit. @return whether the bit was set before */
+  static auto Exchange(const std::unique_ptr<std::atomic<uint64_t>[]> &bitmap, frame_id_t frame_id, bool value)
+      -> bool {
+    auto &word = bitmap[frame_id / BITS_PER_WORD];
+    uint64_t old = value ? word.fetch_or(Bit(frame_id)) : word.fetch_and(~Bit(frame_id));
+    return (old & Bit(frame_id)) != 0;
+  }
+
+  void CheckFrame(frame_id_t frame_id) const;
+
+  size_t num_frames_;
+  std::unique_ptr<std::atomic<uint64_t>[]> tracked_;
+  std::unique_ptr<std::atomic<uint64_t>[]> evictable_;
+  std::unique_ptr<std::atomic<uint64_t>[]> referenced_;
+  /** Position of the clock hand, modulo num_frames_. */
+  std::atomic<size_t> hand_{0};
+  std::atomic<size_t> curr_size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is one contiguous, page-aligned memory region holding the data of all frames of a buffer pool, so that
+ * frame i lives at offset i * BUSTUB_PAGE_SIZE. The arena is mapped anonymously (and so starts out zeroed). If huge
+ * pages are requested, it first tries explicit huge pages (MAP_HUGETLB) and otherwise asks for transparent huge pages.
+ * Memory is only committed when a frame is first touched, so an arena can reserve room for frames that are not in use.
+ */
+class FrameArena {
+ public:
+  /** Size of the huge pages the arena is rounded up to when huge pages are requested. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * @brief Map the arena.
+   * @param num_frames number of frames
+   * @param use_huge_pages back the arena with huge pages where the system allows it
+   */
+  FrameArena(size_t num_frames, bool use_huge_pages);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of the given frame */
+  auto GetFrameData(size_t frame_id) const -> char * { return data_ + frame_id * BUSTUB_PAGE_SIZE; }
+
+  /**
+   * @brief Return the memory of a frame to the operating system. The frame stays mapped and reads as zeros after this.
+   * Does nothing if the arena is backed by explicit huge pages, which can't be released one frame at a time.
+   */
+  void Release(size_t frame_id);
+
+  /** @return true iff the arena is backed by explicit huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  char *data_{nullptr};
+  size_t size_{0};
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
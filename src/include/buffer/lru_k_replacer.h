@@ -12,30 +12,35 @@
 
 #pragma once
 
+#include <functional>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
 class LRUKReplacer;
 class LRUKNode {
   friend class LRUKReplacer;
 
  private:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-
-  std::list<size_t> history_;
-  size_t k_;
-  frame_id_t fid_;
+  /** Timestamp of the oldest access kept in the history. For a frame with k accesses it is the k-th most recent one. */
+  auto Oldest() const -> size_t { return size_ < history_.size() ? history_[0] : history_[head_]; }
+
+  /** Ring buffer of the last seen K timestamps of this page, allocated once. */
+  std::vector<size_t> history_;
+  /** Slot the next access is written to. */
+  size_t head_{0};
+  /** Number of valid timestamps in history_. 0 means the frame is not tracked. */
+  size_t size_{0};
+  /** True if the frame was only ever accessed by scans. Only its latest scan access is kept. */
+  bool is_scan_{false};
   bool is_evictable_{false};
 };
 
@@ -49,9 +54,21 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Timestamps come from a logical counter. Evictable frames are kept in two ordered queues: the history queue holds
+ * frames with fewer than k accesses ordered by their earliest access, the cache queue holds frames with k accesses
+ * ordered by their k-th most recent access. The victim is the front of the history queue, or of the cache queue if the
+ * history queue is empty, so every operation is O(log n) in the number of frames.
+ *
+ * Scan accesses are kept out of the k-history so that one pass over a large table does not flush the working set of
+ * point lookups: a scan access to a frame that is already tracked is ignored, and a frame that has only been scanned
+ * sits in a separate scan queue that is evicted before the other two.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
+  using Replacer::Evict;
+  using Replacer::RecordAccess;
+
   /**
    *
    * TODO(P1): Add implementation
@@ -68,7 +85,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -81,12 +98,19 @@ class LRUKReplacer {
    * based on LRU.
    *
    * Successful eviction of a frame should decrement the size of replacer and remove the frame's
-   * access history.
+   * access history. Frames that can_evict rejects keep their place and history.
    *
    * @param[out] frame_id id of frame that is evicted.
-   * @return true if a frame is evicted successfully, false if no frames can be evicted.
+   * @param can_evict called under the replacer latch for each candidate, must not call back into the replacer
+   * @return true if a frame is evicted successfully, false if no frame was accepted.
+   */
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool override;
+
+  /**
+   * @brief Return the evictable frames that Evict() would pick next, in eviction order, without evicting them.
+   * @param n maximum number of frames to return
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Victims(size_t n) -> std::vector<frame_id_t> override;
 
   /**
    * TODO(P1): Add implementation
@@ -98,10 +122,11 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. AccessType::Scan accesses are not counted toward the
+   * k-history of a frame.
+   * @param page_id unused, the history of a frame is dropped when it is evicted
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -120,7 +145,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -139,7 +164,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -148,12 +173,32 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  /** @brief Return the queue an evictable frame with the given node belongs to. */
+  auto QueueOf(const LRUKNode &node) -> std::set<std::pair<size_t, frame_id_t>> & {
+    if (node.is_scan_) {
+      return scan_queue_;
+    }
+    return node.size_ < k_ ? history_queue_ : cache_queue_;
+  }
+
+  /** @brief Forget the access history of a frame. */
+  static void ResetNode(LRUKNode *node) {
+    node->head_ = 0;
+    node->size_ = 0;
+    node->is_scan_ = false;
+  }
+
+  /** Per-frame access history, indexed by frame id. */
+  std::vector<LRUKNode> node_store_;
+  /** Evictable frames that have only been scanned, ordered by (latest scan access, frame id). */
+  std::set<std::pair<size_t, frame_id_t>> scan_queue_;
+  /** Evictable frames with fewer than k accesses, ordered by (earliest access, frame id). */
+  std::set<std::pair<size_t, frame_id_t>> history_queue_;
+  /** Evictable frames with k accesses, ordered by (k-th most recent access, frame id). */
+  std::set<std::pair<size_t, frame_id_t>> cache_queue_;
   size_t current_timestamp_{0};
   size_t curr_size_{0};
   size_t replacer_size_;
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <mutex>  // NOLINT
 #include <vector>
@@ -23,9 +24,15 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Tracked frames are kept in one list from the least to the most recently used. A scan access does not move a frame
+ * that is already tracked, and a frame first seen by a scan is put at the least recently used end.
  */
 class LRUReplacer : public Replacer {
  public:
+  using Replacer::Evict;
+  using Replacer::RecordAccess;
+
   /**
    * Create a new LRUReplacer.
    * @param num_pages the maximum number of pages the LRUReplacer will be required to store
@@ -37,16 +44,31 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool override;
+
+  auto Victims(size_t n) -> std::vector<frame_id_t> override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  struct Node {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** Per-frame state, indexed by frame id. */
+  std::vector<Node> nodes_;
+  /** Tracked frames, least recently used first. */
+  std::list<frame_id_t> lru_list_;
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
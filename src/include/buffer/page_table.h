@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to frame ids with a fixed-capacity open-addressing hash table (linear probing) whose slots
+ * are single atomic words, so it can be read without any latch.
+ *
+ * Writers (Insert, Erase, ForEach) must be serialized by the caller, e.g. by the buffer pool shard latch. Find() may
+ * run concurrently with them. A concurrent Find() can miss an entry that an Erase() is moving, and it can return a
+ * mapping that has just been erased or replaced, but never one that was never inserted; lock-free callers must
+ * validate the frame they get and fall back to a latched lookup on a miss.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create an empty page table.
+   * @param max_entries maximum number of entries the table will ever hold at the same time
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Look up a page. Lock-free.
+   * @param page_id id of the page
+   * @param[out] frame_id frame the page maps to
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /** @brief Insert or replace the mapping of a page. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of a page.
+   * @return false if the page was not in the table
+   */
+  auto Erase(page_id_t page_id) -> bool;
+
+  /** @brief Return the number of entries. */
+  auto Size() const -> size_t { return size_; }
+
+  /** @brief Call f(page_id, frame_id) for every entry. */
+  template <class F>
+  void ForEach(F &&f) const {
+    for (size_t i = 0; i <= mask_; ++i) {
+      uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+      if (entry != EMPTY) {
+        f(KeyOf(entry), FrameOf(entry));
+      }
+    }
+  }
+
+ private:
+  /** An entry is the page id in the high and the frame id in the low 32 bits. Page id -1 is never inserted. */
+  static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto KeyOf(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto FrameOf(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & 0xFFFFFFFF); }
+
+  /** @brief Return the home slot of a page. */
+  auto Home(page_id_t page_id) const -> size_t {
+    // Fibonacci hashing, page ids of a shard are spaced by the shard count
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> shift_;
+  }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  size_t mask_;
+  size_t shift_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
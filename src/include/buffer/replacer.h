@@ -12,12 +12,26 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policies a buffer pool can be configured with, see MakeReplacer(). */
+enum class ReplacerPolicy { LRUK = 0, LRU, Clock, TwoQ, ARC };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks page usage and decides which frame to evict.
+ *
+ * A frame is tracked from its first recorded access until it is evicted or removed. Only tracked frames that are
+ * marked as evictable can be picked as victims. Policies that keep a history of evicted pages (2Q, ARC) recognize a
+ * page that comes back by the page id passed to RecordAccess().
  */
 class Replacer {
  public:
@@ -25,26 +39,76 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Evict a frame as defined by the replacement policy.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  auto Evict(frame_id_t *frame_id) -> bool {
+    return Evict(frame_id, [](frame_id_t) { return true; });
+  }
+
+  /**
+   * Evict the first evictable frame, in eviction order, that can_evict accepts. Frames it rejects keep their place and
+   * history. Lets a caller veto frames whose evictability it tracks itself (e.g. in an atomic pin count).
+   * @param[out] frame_id id of frame that was evicted
+   * @param can_evict called for each candidate, must not call back into the replacer
+   * @return true if a frame was evicted, false if no frame was accepted
+   */
+  virtual auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool = 0;
+
+  /**
+   * Return the evictable frames that Evict() would pick next, in eviction order, without evicting them.
+   * @param n maximum number of frames to return
+   */
+  virtual auto Victims(size_t n) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Record an access to a frame whose page is not known.
+   * @param frame_id id of the frame that was accessed
+   * @param access_type type of the access
+   */
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) {
+    RecordAccess(frame_id, access_type, INVALID_PAGE_ID);
+  }
+
+  /**
+   * Record an access to a frame. Starts tracking the frame if it is not tracked yet.
+   * @param frame_id id of the frame that was accessed
+   * @param access_type type of the access. Scans should not displace pages that are accessed repeatedly.
+   * @param page_id the page held by the frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Mark a tracked frame as evictable or not. Size() counts the evictable frames.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Stop tracking an evictable frame, e.g. because its page was deleted. Unlike Evict(), no history of the page is
+   * kept. Does nothing if the frame is not tracked.
+   * @param frame_id id of the frame
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames number of frames the replacer tracks, frame ids are in [0, num_frames)
+ * @param k the lookback constant k, only used by ReplacerPolicy::LRUK
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k = LRUK_REPLACER_K) -> std::unique_ptr<Replacer>;
+
+/** @return the policy named name ("lru-k", "lru", "clock", "2q" or "arc"), throws Exception for an unknown name */
+auto ParseReplacerPolicy(const std::string &name) -> ReplacerPolicy;
+
+/** @return the name of a policy, as accepted by ParseReplacerPolicy() */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
 }  // namespace bustub
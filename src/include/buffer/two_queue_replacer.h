@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q replacement policy (Johnson and Shasha, VLDB '94).
+ *
+ * A page seen for the first time enters A1in, a FIFO that holds about a quarter of the frames. While A1in is over that
+ * size, it is evicted from first, and the ids of pages evicted from it are remembered in A1out, a FIFO of page ids
+ * sized to half the frames. Only a page that is accessed again after it went through A1in and A1out is promoted to
+ * Am, the LRU list holding the working set. Repeated accesses while a page is still in A1in do not count, so short
+ * bursts of correlated references and one-off scans never reach Am. A scan access never promotes a page.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  using Replacer::Evict;
+  using Replacer::RecordAccess;
+
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool override;
+
+  auto Victims(size_t n) -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  enum class Queue { None, In, Main };
+
+  struct Node {
+    Queue queue_{Queue::None};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** @return the queues in the order they are evicted from */
+  auto EvictionOrder() -> std::vector<std::list<frame_id_t> *>;
+
+  /** Add a page id to A1out, forgetting the oldest one if it is full. */
+  void Remember(page_id_t page_id);
+
+  /** Per-frame state, indexed by frame id. */
+  std::vector<Node> nodes_;
+  /** A1in: frames seen once, oldest first. */
+  std::list<frame_id_t> in_queue_;
+  /** Am: frames of the working set, least recently used first. */
+  std::list<frame_id_t> main_queue_;
+  /** A1out: ids of pages evicted from A1in, oldest first. */
+  std::list<page_id_t> ghost_queue_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> ghosts_;
+  /** Kin and Kout of the paper. */
+  size_t in_capacity_;
+  size_t ghost_capacity_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
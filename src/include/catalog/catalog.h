@@ -228,12 +228,22 @@ class Catalog {
     // TODO(chi): support both hash index and btree index
     auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap. The keys are sorted and the tree is built bottom-up,
+    // which is much faster than inserting them one by one and packs the leaves instead of leaving them half full.
     auto *table_meta = GetTable(table_name);
-    for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
-      auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
-    }
+    auto iter = table_meta->table_->MakeIterator();
+    index->BulkLoad(
+        [&](Tuple *key, RID *rid) {
+          if (iter.IsEnd()) {
+            return false;
+          }
+          auto [meta, tuple] = iter.GetTuple();
+          *key = tuple.KeyFromTuple(schema, key_schema, key_attrs);
+          *rid = tuple.GetRid();
+          ++iter;
+          return true;
+        },
+        txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/util/string_util.h"
@@ -210,6 +211,21 @@ class FortTableWriter : public ResultWriter {
   std::vector<std::string> tables_;
 };
 
+/**
+ * Buffer pool settings of a BusTub instance.
+ */
+struct BufferPoolOptions {
+  /** Number of frames. We need more frames for GenerateTestTable to work, so the default is larger than the buffer
+   * pool size specified in `config.h`. */
+  size_t pool_size_{128};
+  /** Largest number of frames `SET buffer_pool_size` can grow the pool to. */
+  size_t max_pool_size_{4096};
+  /** Back the frame arena with huge pages. */
+  bool use_huge_pages_{false};
+  /** Replacement policy of the buffer pool. */
+  ReplacerPolicy replacer_policy_{ReplacerPolicy::LRUK};
+};
+
 class BustubInstance {
  private:
   /**
@@ -218,9 +234,9 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn, bool is_modify) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  explicit BustubInstance(const std::string &db_file_name, BufferPoolOptions options = {});
 
-  BustubInstance();
+  explicit BustubInstance(BufferPoolOptions options = {});
 
   ~BustubInstance();
 
@@ -278,6 +294,7 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  void CmdDisplayBpmStats(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
 
@@ -27,15 +27,21 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Number of pages ahead of the current one a table scan keeps prefetching. 0 disables read-ahead. */
+extern std::atomic<size_t> scan_prefetch_window;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_CACHELINE_SIZE = 64;                                     // size of a cache line in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int DISK_SCHEDULER_NUM_WORKERS = 8;  // number of background I/O threads per disk scheduler
+static constexpr int DISK_SCHEDULER_MAX_BATCH = 64;   // max requests a scheduler worker hands to the disk at once
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
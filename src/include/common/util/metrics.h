@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics.h
+//
+// Identification: src/include/common/util/metrics.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * StripedCounter is a counter for hot paths. It is split into cache-line sized stripes and every thread adds to its
+ * own stripe, so threads that count concurrently do not bounce a cache line between them. Reading sums all stripes
+ * and is only as exact as a relaxed snapshot of a running counter can be.
+ */
+class StripedCounter {
+ public:
+  /** Number of stripes. Threads are assigned a stripe round-robin when they first count. */
+  static constexpr size_t NUM_STRIPES = 16;
+
+  StripedCounter() = default;
+  DISALLOW_COPY_AND_MOVE(StripedCounter);
+
+  /** @brief Add n to the stripe of the calling thread. */
+  void Add(uint64_t n = 1) { stripes_[StripeIndex()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the sum of all stripes */
+  auto Load() const -> uint64_t;
+
+  /** @brief Set all stripes to 0. Adds that run concurrently may or may not be lost. */
+  void Reset();
+
+ private:
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> value_{0};
+  };
+
+  /** @return the stripe of the calling thread */
+  static auto StripeIndex() -> size_t;
+
+  std::array<Stripe, NUM_STRIPES> stripes_{};
+};
+
+/** A copy of the buckets of a LatencyHistogram, see LatencyHistogram::Snapshot(). All values are in nanoseconds. */
+struct HistogramSnapshot {
+  /** Number of recorded values per bucket. */
+  std::vector<uint64_t> buckets_;
+  /** Number of recorded values. */
+  uint64_t count_{0};
+  /** Sum of the recorded values. */
+  uint64_t sum_{0};
+  /** Largest recorded value. */
+  uint64_t max_{0};
+
+  /** @return the average of the recorded values, 0 if there are none */
+  auto Mean() const -> double { return count_ == 0 ? 0 : static_cast<double>(sum_) / static_cast<double>(count_); }
+
+  /**
+   * @return an upper bound of the q-quantile of the recorded values, at most 1/8 above the real value. 0 if there are
+   * no values.
+   * @param q the quantile, in [0, 1]
+   */
+  auto Percentile(double q) const -> uint64_t;
+};
+
+/**
+ * LatencyHistogram counts durations in log-linear buckets: every power of two is split into SUB_BUCKETS linear
+ * buckets, like in HdrHistogram. So the relative error of a bucket is bounded by 1/SUB_BUCKETS over the whole range of
+ * 64-bit values with a fixed, small number of buckets. Recording is one relaxed increment per bucket and sum, safe to
+ * call from any thread without a latch.
+ */
+class LatencyHistogram {
+ public:
+  /** log2 of SUB_BUCKETS. */
+  static constexpr size_t SUB_BUCKET_BITS = 3;
+  /** Number of linear buckets per power of two. */
+  static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  /** Values below SUB_BUCKETS get a bucket each, then there are SUB_BUCKETS buckets for each higher power of two. */
+  static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  LatencyHistogram() = default;
+  DISALLOW_COPY_AND_MOVE(LatencyHistogram);
+
+  /** @brief Record a duration in nanoseconds. */
+  void Record(uint64_t nanos);
+
+  /** @brief Record the time passed since start. */
+  void RecordSince(std::chrono::steady_clock::time_point start) {
+    Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  /** @return a copy of the buckets. Values recorded concurrently may or may not be included. */
+  auto Snapshot() const -> HistogramSnapshot;
+
+  /** @brief Drop all recorded values. */
+  void Reset();
+
+  /** @return the bucket a value falls into */
+  static auto BucketOf(uint64_t value) -> size_t;
+
+  /** @return the smallest value of a bucket */
+  static auto BucketLowerBound(size_t bucket) -> uint64_t;
+
+  /** @return the largest value of a bucket */
+  static auto BucketUpperBound(size_t bucket) -> uint64_t;
+
+ private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+}  // namespace bustub
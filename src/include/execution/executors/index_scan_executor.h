@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
@@ -48,7 +49,9 @@ class IndexScanExecutor : public AbstractExecutor {
   const IndexScanPlanNode *plan_;
   Catalog *catalog_;
   IndexInfo *index_info_;
-  BPlusTreeIndexForTwoIntegerColumn *index_;
-  BPlusTreeIndexIteratorForTwoIntegerColumn iter_;
+  TableInfo *table_info_;
+  /** The rids of the keys in the range of the plan, collected before any row is locked. */
+  std::vector<RID> rids_;
+  size_t cursor_;
 };
 }  // namespace bustub
@@ -14,14 +14,20 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * The scan may be bounded: it then starts at the lower bound and stops after the upper bound. A bound holds values
+ * of the first columns of the index key, so (5) bounds an index on (v1, v3) to the keys whose v1 is 5. A missing bound
+ * scans from the first key, or to the last one. The filter predicate is evaluated on every tuple the scan reaches.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -29,9 +35,22 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param filter_predicate the predicate the scanned tuples must satisfy, nullptr for none
+   * @param lower_bound the values of the first key columns to start at, empty to start at the first key
+   * @param lower_inclusive whether keys equal to the lower bound are scanned
+   * @param upper_bound the values of the first key columns to stop after, empty to scan to the last key
+   * @param upper_inclusive whether keys equal to the upper bound are scanned
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr,
+                    std::vector<Value> lower_bound = {}, bool lower_inclusive = true,
+                    std::vector<Value> upper_bound = {}, bool upper_inclusive = true)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        filter_predicate_(std::move(filter_predicate)),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -45,9 +64,36 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   // Add anything you want here for index lookup
 
+  /** The predicate to filter the scanned tuples with. */
+  AbstractExpressionRef filter_predicate_;
+
+  /** The range of keys to scan. */
+  std::vector<Value> lower_bound_;
+  bool lower_inclusive_;
+  std::vector<Value> upper_bound_;
+  bool upper_inclusive_;
+
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (lower_bound_.empty() && upper_bound_.empty() && !filter_predicate_) {
+      return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    }
+    std::string range = lower_bound_.empty() ? "(-inf" : (lower_inclusive_ ? "[" : "(") + BoundToString(lower_bound_);
+    range += ", ";
+    range += upper_bound_.empty() ? "+inf)" : BoundToString(upper_bound_) + (upper_inclusive_ ? "]" : ")");
+    if (filter_predicate_) {
+      return fmt::format("IndexScan {{ index_oid={}, range={}, filter={} }}", index_oid_, range, filter_predicate_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, range={} }}", index_oid_, range);
+  }
+
+ private:
+  static auto BoundToString(const std::vector<Value> &bound) -> std::string {
+    std::string str = "(";
+    for (size_t i = 0; i < bound.size(); i++) {
+      str += (i == 0 ? "" : ",") + bound[i].ToString();
+    }
+    return str + ")";
   }
 };
 
@@ -83,6 +83,13 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize seq scan with a filter predicate as an index scan over the range of keys the predicate allows,
+   * e.g., `WHERE v1 = 1 AND v3 > 2` as an index scan on (v1, v3) from (1,2) exclusive to (1) inclusive. Must run
+   * after MergeFilterScan.
+   */
+  auto OptimizeSeqScanAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
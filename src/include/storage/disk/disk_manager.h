@@ -13,18 +13,41 @@
 #pragma once
 
 #include <atomic>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/**
+ * A page read or write handed to DiskManager::ExecuteBatch().
+ */
+struct DiskIO {
+  /** Flag indicating whether the I/O is a write or a read. */
+  bool is_write_;
+  /** ID of the (first) page being read from / written to disk. */
+  page_id_t page_id_;
+  /** Buffer holding num_pages_ pages back to back. */
+  char *data_;
+  /** Number of consecutive pages. Only writes may span pages. */
+  size_t num_pages_{1};
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Page ids are handed out by AllocatePage() from a free space map: a bitmap with one bit per page of the file that is
+ * set for pages that were deallocated. Free pages are reused before the file grows, lowest page id first, so the file
+ * stays compact and Shrink() can cut off the free pages at its end. A disk manager on a database file keeps the map in
+ * a file next to it (`<db>.fsm`), which is written by Sync() and ShutDown() and read back when the database file is
+ * opened again.
  */
 class DiskManager {
  public:
@@ -34,7 +57,7 @@ class DiskManager {
    */
   explicit DiskManager(const std::string &db_file);
 
-  /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
+  /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory and DiskManagerMmap */
   DiskManager() = default;
 
   virtual ~DiskManager() = default;
@@ -42,7 +65,7 @@ class DiskManager {
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -51,6 +74,14 @@ class DiskManager {
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write consecutive pages to the database file with a single write.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of num_pages pages stored back to back
+   * @param num_pages number of pages
+   */
+  virtual void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -58,6 +89,61 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Make all previously written pages and the free space map durable. The fstream based disk manager flushes after
+   * every write, so only the map is written here; subclasses that defer durability sync the database file as well.
+   */
+  virtual void Sync() { SaveFreeSpaceMap(); }
+
+  /**
+   * Allocate a page. The lowest free page id is reused; if there is none, the file grows by the page.
+   *
+   * Callers that partition the page ids can ask for an id of their own partition: then only ids with
+   * `page_id % num_partitions == partition` are handed out. Ids of other partitions that the file grows by on the way
+   * are marked free, so they are handed out to their own partition later.
+   *
+   * @param num_partitions number of partitions of the page ids
+   * @param partition partition of the page id to allocate, less than num_partitions
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(size_t num_partitions = 1, size_t partition = 0) -> page_id_t;
+
+  /**
+   * Return a page to the free space map, so that its id can be handed out again. Does nothing if the page is not
+   * allocated.
+   * @param page_id id of the page
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true if page_id was handed out by AllocatePage() (or lies in the file) and was not deallocated */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /** @return the number of pages in the file, allocated or free */
+  auto GetNumPages() -> size_t;
+
+  /** @return the number of free pages in the file */
+  auto GetNumFreePages() -> size_t;
+
+  /**
+   * Cut the free pages at the end of the file off, shrinking the database file. This is an offline operation: no buffer
+   * pool may use the disk manager at the same time.
+   * @return the number of pages the file shrank by
+   */
+  auto Shrink() -> size_t;
+
+  /**
+   * Execute a batch of independent page reads and writes. Implementations may run them concurrently and complete them
+   * in any order; on_complete is called exactly once per I/O with its index in ios and, if it failed, the exception.
+   * The call returns after every I/O of the batch has completed. The default runs them one after another.
+   * @param ios the I/Os to execute
+   * @param on_complete completion callback, possibly invoked from another thread
+   */
+  virtual void ExecuteBatch(const std::vector<DiskIO> &ios,
+                            const std::function<void(size_t, std::exception_ptr)> &on_complete);
+
+  /** @return how many I/Os a caller should put in one ExecuteBatch() call; 1 if batches gain nothing */
+  virtual auto GetMaxBatchSize() const -> size_t { return 1; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -94,6 +180,19 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+
+  /**
+   * Read the free space map of the database file from fsm_name_. Pages of the file missing in it are allocated.
+   * @param num_file_pages number of pages the database file holds, 0 for a new database
+   */
+  void LoadFreeSpaceMap(size_t num_file_pages);
+
+  /** Write the free space map to fsm_name_ if it changed. Does nothing for a disk manager without a database file. */
+  void SaveFreeSpaceMap();
+
+  /** Drop the pages from num_pages on from the database file, see Shrink(). Called with fsm_latch_ held. */
+  virtual void TruncateFile(size_t num_pages);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -101,11 +200,26 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+
+  /** File the free space map is kept in. Empty if it is not persisted. */
+  std::string fsm_name_;
+  /** Protects the free space map. */
+  std::mutex fsm_latch_;
+  /** One bit per page, set if the page is free. */
+  std::vector<uint64_t> free_pages_;
+  /** Number of pages in the file, i.e. one more than the largest page id ever handed out. */
+  size_t num_pages_{0};
+  /** Number of set bits of free_pages_. */
+  size_t num_free_pages_{0};
+  /** All words of free_pages_ below this one are 0. */
+  size_t first_free_word_{0};
+  /** Whether the map changed since it was last saved. */
+  bool fsm_dirty_{false};
 };
 
 }  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.h
+//
+// Identification: src/include/storage/disk/disk_manager_compressed.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerCompressed compresses every page with PageCodec before it goes to disk. The database file is a heap of
+ * variable-sized slots instead of an array of pages: a slot map from page id to the offset, size and capacity of the
+ * slot of the page is kept in memory and saved next to the database file (`<db>.cmap`). A page that is written again
+ * stays in its slot if it still fits, otherwise it moves to a free extent or the end of the file. Pages that do not
+ * compress are stored as they are. Page ids, the free space map and the log work as in DiskManager.
+ *
+ * Like DiskManagerPosix, the file is accessed with pread/pwrite outside of any latch, and writes are only durable after
+ * Sync(), which syncs the file before it saves the slot map. A database file without its slot map can't be opened.
+ */
+class DiskManagerCompressed : public DiskManager {
+ public:
+  /** Slots are allocated in multiples of this size, so a page whose compressed size changes a little stays put. */
+  static constexpr size_t SLOT_ALIGNMENT = 64;
+
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   */
+  explicit DiskManagerCompressed(const std::string &db_file);
+
+  ~DiskManagerCompressed() override;
+
+  /**
+   * Shut down the disk manager, saving the slot map, and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Compress a page and write it to its slot.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Write consecutive pages. Their slots are not consecutive, so this is one write per page.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of num_pages pages stored back to back
+   * @param num_pages number of pages
+   */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) override;
+
+  /**
+   * Read and decompress a page. Pages that were never written read as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * fdatasync the database file, then save the slot map and the free space map.
+   */
+  void Sync() override;
+
+  /**
+   * Return a page to the free space map and free its slot.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return the size of the pages with a slot divided by the size they are compressed to, 1 if there are none */
+  auto GetCompressionRatio() -> double;
+
+  /** @return the number of bytes the pages with a slot are compressed to */
+  auto GetStoredBytes() -> size_t;
+
+  /** @return the bytes of the database file taken by the slots, including the free extents between them */
+  auto GetFileBytes() -> size_t;
+
+ protected:
+  /** Free the slots of the pages from num_pages on and cut the free extents at the end of the file off. */
+  void TruncateFile(size_t num_pages) override;
+
+ private:
+  /** Where a page is stored. size_ == BUSTUB_PAGE_SIZE means it is stored uncompressed. */
+  struct Slot {
+    uint64_t offset_;
+    uint32_t size_;
+    uint32_t capacity_;
+  };
+
+  /** @return the offset of a free extent of size bytes, taken from the free extents or the end of the file */
+  auto AllocateExtent(size_t size) -> uint64_t;
+
+  /** Give an extent back, merging it with its free neighbours. Called with db_io_latch_ held. */
+  void FreeExtent(uint64_t offset, size_t size);
+
+  /** Read the slot map from map_name_ and rebuild the free extents from the gaps between the slots. */
+  void LoadSlotMap();
+
+  /** Write the slot map to map_name_ if it changed. */
+  void SaveSlotMap();
+
+  int fd_{-1};
+  /** File the slot map is kept in. */
+  std::string map_name_;
+  /** The slot of every page that was written. Protected by db_io_latch_, like the rest of the members. */
+  std::unordered_map<page_id_t, Slot> slots_;
+  /** Free extents between the slots, offset -> size. */
+  std::map<uint64_t, uint64_t> free_extents_;
+  /** The same free extents, size -> offset, to find the smallest one a slot fits into. */
+  std::multimap<uint64_t, uint64_t> free_extents_by_size_;
+  /** End of the last slot. */
+  uint64_t file_end_{0};
+  /** Sum of the compressed sizes of all slots. */
+  size_t stored_bytes_{0};
+  /** Whether the slot map changed since it was last saved. */
+  bool map_dirty_{false};
+};
+
+}  // namespace bustub
@@ -46,6 +46,14 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /**
+   * Write consecutive pages to the database file.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of num_pages pages stored back to back
+   * @param num_pages number of pages
+   */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -74,19 +82,22 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     if (latency_ > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
+    WritePageNoLatency(page_id, page_data);
+  }
 
-    std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size())) {
-      data_.resize(page_id + 1);
+  /**
+   * Write consecutive pages to the database file. The disk latency is paid once for the whole batch.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of num_pages pages stored back to back
+   * @param num_pages number of pages
+   */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) override {
+    if (latency_ > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
-    if (data_[page_id] == nullptr) {
-      data_[page_id] = std::make_shared<ProtectedPage>();
+    for (size_t i = 0; i < num_pages; i++) {
+      WritePageNoLatency(first_page_id + static_cast<page_id_t>(i), pages_data + i * BUSTUB_PAGE_SIZE);
     }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
-    std::unique_lock<std::shared_mutex> l_page(ptr->second);
-    l.unlock();
-
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
   }
 
   /**
@@ -118,6 +129,21 @@ class DiskManagerUnlimitedMemory : public DiskManager {
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
 
  private:
+  void WritePageNoLatency(page_id_t page_id, const char *page_data) {
+    std::unique_lock<std::mutex> l(mutex_);
+    if (page_id >= static_cast<int>(data_.size())) {
+      data_.resize(page_id + 1);
+    }
+    if (data_[page_id] == nullptr) {
+      data_[page_id] = std::make_shared<ProtectedPage>();
+    }
+    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::unique_lock<std::shared_mutex> l_page(ptr->second);
+    l.unlock();
+
+    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+  }
+
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap serves a read-only snapshot of an existing database file. The file is mapped into memory once when
+ * the disk manager is created, and ReadPage is a memcpy out of the mapping, with no system call or latch per read.
+ * Pages written to the file afterwards by another process may or may not be visible; pages past the end of the
+ * snapshot read as zeros. Any attempt to write throws, so the buffer pool using it must never dirty a page.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Maps the specified database file.
+   * @param db_file the file name of the database file to read from. It is opened read-only and must exist.
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  /**
+   * Unmap the database file.
+   */
+  void ShutDown() override;
+
+  /** Always throws, the mapping is read-only. */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** Always throws, the mapping is read-only. */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) override;
+
+  /**
+   * Copy a page out of the mapping.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * @param page_id id of the page
+   * @return the page inside the mapping, or nullptr if the page is past the end of the snapshot
+   */
+  auto GetPagePointer(page_id_t page_id) const -> const char *;
+
+  /** @return the size of the mapped snapshot in bytes */
+  auto GetMappedSize() const -> size_t { return size_; }
+
+ private:
+  void Unmap();
+
+  int fd_{-1};
+  char *data_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.h
+//
+// Identification: src/include/storage/disk/disk_manager_posix.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerPosix reads and writes the database file through a raw file descriptor with positional pread/pwrite, so
+ * that concurrent requests (e.g. from several disk scheduler workers) do not serialize on a file cursor or a latch.
+ * Writes are not synced one by one; durability is only guaranteed after Sync() (fdatasync). The log file is still
+ * handled by the base DiskManager.
+ */
+class DiskManagerPosix : public DiskManager {
+ public:
+  /** Alignment required for buffers, offsets and lengths under O_DIRECT. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache. Falls back to buffered I/O if
+   * the file system does not support it.
+   */
+  explicit DiskManagerPosix(const std::string &db_file, bool direct_io = false);
+
+  ~DiskManagerPosix() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Write consecutive pages to the database file with a single pwrite.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of num_pages pages stored back to back
+   * @param num_pages number of pages
+   */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) override;
+
+  /**
+   * Read a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * fdatasync the database file.
+   */
+  void Sync() override;
+
+  /** @return true iff the database file was opened with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+ protected:
+  /** pwrite the whole buffer at offset, going through an aligned bounce buffer if O_DIRECT requires it. */
+  void WriteAt(size_t offset, const char *data, size_t size);
+
+  /** Raise the cached file size to at least end. */
+  void GrowFileSize(size_t end);
+
+  int fd_{-1};
+  bool direct_io_{false};
+  /** cached size of the database file, so reads do not need a stat() per call */
+  std::atomic<size_t> file_size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/channel.h"
+#include "storage/disk/disk_manager_posix.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * DiskManagerUring executes batches of page reads and writes asynchronously. A batch is pushed into an io_uring
+ * submission queue and reaped from its completion queue, so a single disk scheduler worker keeps up to queue_depth
+ * I/Os in flight. If the kernel does not provide io_uring (or it is disabled), batches are spread over a small pool
+ * of threads issuing pread/pwrite instead. Single-page ReadPage/WritePage calls behave as in DiskManagerPosix.
+ */
+class DiskManagerUring : public DiskManagerPosix {
+ public:
+  static constexpr size_t DEFAULT_QUEUE_DEPTH = 64;
+  static constexpr size_t FALLBACK_NUM_THREADS = 8;
+
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT
+   * @param use_io_uring set to false to always use the thread-pool fallback
+   * @param queue_depth maximum number of I/Os in flight per batch
+   */
+  explicit DiskManagerUring(const std::string &db_file, bool direct_io = false, bool use_io_uring = true,
+                            size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+
+  ~DiskManagerUring() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Execute a batch of I/Os with io_uring, or on the fallback thread pool.
+   * @param ios the I/Os to execute
+   * @param on_complete completion callback
+   */
+  void ExecuteBatch(const std::vector<DiskIO> &ios,
+                    const std::function<void(size_t, std::exception_ptr)> &on_complete) override;
+
+  /** @return the queue depth */
+  auto GetMaxBatchSize() const -> size_t override { return queue_depth_; }
+
+  /** @return true iff batches go through io_uring rather than the fallback thread pool */
+  auto UsesIoUring() const -> bool { return ring_fd_ >= 0; }
+
+ private:
+  auto SetUpRing() -> bool;
+  void TearDownRing();
+  void ExecuteBatchRing(const std::vector<DiskIO> &ios,
+                        const std::function<void(size_t, std::exception_ptr)> &on_complete);
+  void ExecuteBatchPool(const std::vector<DiskIO> &ios,
+                        const std::function<void(size_t, std::exception_ptr)> &on_complete);
+  /** Execute one I/O with blocking pread/pwrite and report it. */
+  void ExecuteSync(const DiskIO &io, size_t idx, const std::function<void(size_t, std::exception_ptr)> &on_complete);
+  void StartPoolThread();
+
+  size_t queue_depth_;
+
+  /** io_uring state, mapped from the kernel. ring_fd_ < 0 means the ring is not in use. */
+  int ring_fd_{-1};
+  void *sq_ptr_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ptr_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned sq_entries_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  /** One batch owns the ring at a time. */
+  std::mutex ring_latch_;
+
+  /** Fallback thread pool. std::nullopt stops a thread. */
+  Channel<std::optional<std::function<void()>>> pool_queue_;
+  std::vector<std::thread> pool_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/channel.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/util/metrics.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Callback used to signal to the request issuer when the request has been completed. */
+  std::promise<bool> callback_;
+
+  /** Number of consecutive pages starting at page_id_ that data_ holds back to back. Only writes may span pages. */
+  size_t num_pages_{1};
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. A pool of
+ * background worker threads drains the shared request queue and hands each request to the disk manager, so several
+ * page reads and writes can be in flight at the same time. If the disk manager accepts batches, a worker also takes
+ * whatever else is queued (up to DiskManager::GetMaxBatchSize()) and submits it with one ExecuteBatch() call. The
+ * issuer waits on the future of the request's promise to learn when it has completed.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Creates a new disk scheduler and starts its worker threads.
+   * @param disk_manager the disk manager that executes the requests
+   * @param num_workers number of background threads issuing requests to the disk manager
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_NUM_WORKERS);
+
+  /**
+   * @brief Drains the request queue and joins all worker threads.
+   */
+  ~DiskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute.
+   *
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Schedules a page read and returns a future that becomes ready once the page has been read.
+   */
+  auto ScheduleRead(page_id_t page_id, char *data) -> std::future<bool>;
+
+  /**
+   * @brief Schedules a write and returns a future that becomes ready once it has been written.
+   * @param page_id id of the first page to write
+   * @param data num_pages pages stored back to back
+   * @param num_pages number of consecutive pages to write with a single disk manager call
+   */
+  auto ScheduleWrite(page_id_t page_id, const char *data, size_t num_pages = 1) -> std::future<bool>;
+
+  /**
+   * @brief Background worker loop. Processes scheduled requests until it pops the shutdown marker.
+   */
+  void StartWorkerThread();
+
+  using DiskSchedulerPromise = std::promise<bool>;
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   *
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> DiskSchedulerPromise { return {}; };
+
+  /** @return the number of worker threads */
+  auto GetNumWorkers() const -> size_t { return workers_.size(); }
+
+  /** @return the time the disk manager took for each read request, from submitting its batch until it completed */
+  auto GetReadLatency() -> LatencyHistogram & { return read_latency_; }
+
+  /** @return the time the disk manager took for each write request, see GetReadLatency() */
+  auto GetWriteLatency() -> LatencyHistogram & { return write_latency_; }
+
+ private:
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+  /** A shared queue to concurrently schedule and process requests. When the DiskScheduler's destructor is called,
+   * `std::nullopt` is put into the queue once per worker to signal the workers to stop execution. */
+  Channel<std::optional<DiskRequest>> request_queue_;
+  /** The background threads responsible for issuing scheduled requests to the disk manager. */
+  std::vector<std::thread> workers_;
+  /** Latency of completed reads and writes. */
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/storage/disk/page_codec.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * PageCodec is a small, self-contained LZ77 codec in the style of the LZ4 block format, used to compress pages on
+ * their way to disk. The input is split into sequences of a run of literal bytes followed by a match, a copy of at
+ * least MIN_MATCH bytes from up to 64 KB back. A sequence is a token byte holding both lengths in 4 bits each (longer
+ * lengths continue in extra bytes of 255), the literals and the 2-byte little-endian offset of the match. The last
+ * sequence has literals only. A match may overlap its own output, so a run of equal bytes, like the zeroed tail of a
+ * page, becomes a single sequence.
+ */
+class PageCodec {
+ public:
+  /** Shortest match that is encoded as a match. */
+  static constexpr size_t MIN_MATCH = 4;
+  /** Largest distance of a match. */
+  static constexpr size_t MAX_OFFSET = 65535;
+
+  /**
+   * @brief Compress src into dst.
+   * @return the size of the compressed data, 0 if it does not fit into capacity bytes
+   */
+  static auto Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * @brief Decompress src, which must decompress to exactly size bytes, into dst.
+   * @return false if src is not valid compressed data of size bytes
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool;
+};
+
+}  // namespace bustub
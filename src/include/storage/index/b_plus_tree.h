@@ -14,6 +14,7 @@
 #include <atomic>
 #include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <queue>
@@ -55,6 +56,9 @@ class Context {
   // You may want to use this when getting value, but not necessary.
   std::deque<ReadPageGuard> read_set_;
 
+  // Pages a remove unlinked from the tree (merged away or an old root). They are deleted once all guards are dropped.
+  std::vector<page_id_t> deleted_pages_;
+
   auto IsRootPage(page_id_t page_id) -> bool { return page_id == root_page_id_; }
 };
 
@@ -67,21 +71,58 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  /** Fill factor of BulkLoad(), leaves a little room so that the first inserts after a load don't split every page. */
+  static constexpr double DEFAULT_FILL_FACTOR = 0.9;
+
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE, bool swizzle = false);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
 
-  // Insert a key-value pair into this B+ tree.
+  /**
+   * @brief Insert a key-value pair into this B+ tree. Most inserts only write-latch their leaf. One that splits its
+   * leaf follows the B-link protocol: the two halves are linked and the left one gets the separator as its high key,
+   * then both are released before the separator is posted to the parent, and so on up the tree. No more than one page
+   * is write-latched at a time; a search that reaches the left half meanwhile moves right to find its key.
+   */
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
-  auto InsertParent(Context &ctx, page_id_t old_value, page_id_t new_value, const KeyType &key);
+
+  /**
+   * @brief Post the separator of a split to the parent of the left half, splitting the parent in turn if it's full.
+   * @param path the internal pages the insert descended through, the parent of the left half last
+   * @param left_id the left half of the split, on level level
+   * @param key the separator, the first key of the right half
+   * @param right_id the right half of the split
+   */
+  void InsertParent(std::vector<page_id_t> *path, page_id_t left_id, int level, const KeyType &key,
+                    page_id_t right_id);
 
   // Remove a key and its value from this B+ tree.
   void DeleteEntry(Context &ctx, const KeyType &key);
+
+  /**
+   * @brief Remove a key and its value from this B+ tree. A remove that underflows its leaf merges or redistributes
+   * pages with write-latch crabbing from the header down. It holds the structure latch exclusively, so it never sees a
+   * split whose separator isn't posted yet.
+   */
   void Remove(const KeyType &key, Transaction *txn);
 
+  /**
+   * @brief Build the tree bottom-up out of entries in ascending key order, instead of inserting them one by one. The
+   * leaves are filled left to right up to fill_factor of their capacity, then every level of internal pages is built
+   * over the level below until a single root is left. The last two pages of a level are evened out if the last one
+   * would be less than half full. An entry with the same key as the entry before it is skipped, as Insert would.
+   * The header page stays write-latched until the root is in place, so concurrent writers wait for the load.
+   *
+   * @param next produces the next entry, returns false after the last one
+   * @param fill_factor fraction of a page to fill, in (0, 1]. Less than 1 leaves room for inserts after the load.
+   * @return false if the tree is not empty
+   */
+  auto BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = DEFAULT_FILL_FACTOR)
+      -> bool;
+
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
@@ -134,6 +175,66 @@ class BPlusTree {
    */
   auto ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree;
 
+  /**
+   * @brief Fetch the child at a slot of an internal page during a descent. In swizzled mode the buffer pool follows the
+   * parent frame's swip for the slot instead of looking the child up in its page table. The root is slot 0 of the
+   * header page.
+   */
+  auto FetchChildRead(const ReadPageGuard &parent, int slot, page_id_t child_id) -> ReadPageGuard;
+  auto FetchChildWrite(const WritePageGuard &parent, int slot, page_id_t child_id) -> WritePageGuard;
+  auto FetchChildOptimistic(const OptimisticReadGuard &parent, int slot, page_id_t child_id) -> OptimisticReadGuard;
+
+  /**
+   * @brief Find the leaf that may contain key. The header and the internal pages are read optimistically (no pin, no
+   * latch) and validated; only the leaf is read-latched. The descent restarts from the header whenever a page it read
+   * was changed meanwhile. An optimistic parent is not pinned, so loading a child may evict it; after
+   * MAX_OPTIMISTIC_RESTARTS failed attempts the descent falls back to read-latch crabbing, which always makes progress.
+   *
+   * @return guard of the leaf, std::nullopt if the tree is empty
+   */
+  auto FindLeafOptimistic(const KeyType &key) -> std::optional<ReadPageGuard>;
+  auto FindLeafRead(const KeyType &key) -> std::optional<ReadPageGuard>;
+
+  /**
+   * @brief Find the leaf that may contain key like FindLeafOptimistic, but write-latch it. This is the fast path of
+   * Insert and Remove, which only change the leaf unless it splits or underflows; the header and the root are not
+   * latched at all. A leaf that is already full (for an insert) or at its minimum size (for a remove) is not latched,
+   * the caller would only have to let it go again. Unlike FindLeafOptimistic there is a single attempt: a page that
+   * changed or was evicted during the descent sends the caller straight to the pessimistic path.
+   *
+   * @return guard of the leaf, std::nullopt if the tree is empty, the leaf is not safe or the descent failed, in which
+   * case the caller takes the pessimistic path
+   */
+  auto FindLeafWriteOptimistic(const KeyType &key, bool insert) -> std::optional<WritePageGuard>;
+
+  /**
+   * @brief One optimistic descent from the header to the leaf that may contain key.
+   * @param[out] leaf the leaf, not latched yet; it holds no page if the tree is empty
+   * @return false if a page was changed during the descent and it has to restart
+   */
+  auto DescendOptimistic(const KeyType &key, OptimisticReadGuard *leaf) -> bool;
+
+  /** Insert key/value at pos of a leaf that has room for it. */
+  void InsertIntoLeaf(LeafPage *leaf_page, int pos, const KeyType &key, const ValueType &value);
+
+  /**
+   * @return true if key is not less than the high key of page, i.e. the page split after its parent was read and key
+   * is to the right of it now
+   */
+  auto IsBeyond(const BPlusTreePage *page, const KeyType &key) const -> bool;
+
+  /**
+   * @brief Find the leaf that may contain key with read-latch crabbing, recording the internal pages on the way, and
+   * write-latch it.
+   * @return guard of the leaf, std::nullopt if the tree is empty
+   */
+  auto FindLeafWrite(const KeyType &key, std::vector<page_id_t> *path) -> std::optional<WritePageGuard>;
+
+  /** @return the page on level that covers key, found from the root down */
+  auto FindPageOnLevel(const KeyType &key, int level) -> page_id_t;
+
+  static constexpr int MAX_OPTIMISTIC_RESTARTS = 4;
+
   // member variable
   std::string index_name_;
   BufferPoolManager *bpm_;
@@ -142,6 +243,10 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  // descend through swips, see BufferPoolManager::FetchChildRead()
+  bool swizzle_;
+  // 分裂往上插入分隔key的时候共享, 合并和借用的时候独占, 删除不会看到只分裂了一半的节点
+  std::shared_mutex structure_latch_;
 };
 
 /**
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,6 +28,9 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
+  /** Number of entries BulkLoad() sorts in memory before it spills them to disk. */
+  static constexpr size_t SORT_RUN_SIZE = 1 << 20;
+
   BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
@@ -35,6 +39,19 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanRange(const std::vector<char> &lower, bool lower_inclusive, const std::vector<char> &upper,
+                 bool upper_inclusive, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * @brief Fill the empty index with the (key tuple, rid) pairs produced by next. The keys are sorted with an
+   * ExternalSorter, which spills runs of sort_run_size entries to temporary pages, and the tree is built from them
+   * bottom-up with BPlusTree::BulkLoad(). Of several entries with the same key only the first one is kept, as with
+   * InsertEntry().
+   * @return false if the index is not empty
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction,
+                size_t sort_run_size = SORT_RUN_SIZE) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -44,6 +61,7 @@ class BPlusTreeIndex : public Index {
  protected:
   // comparator for key
   KeyComparator comparator_;
+  BufferPoolManager *bpm_;
   // container
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
 };
@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts more entries than fit in memory, for building an index bottom-up. Entries are collected into a
+ * run of at most run_size entries; a full run is sorted and written to temporary pages of the buffer pool. Once all
+ * entries are added, the runs are merged, at most a quarter of the buffer pool's frames at a time so that the merge
+ * never pins more pages than the pool has, until one merge can produce the sorted output. If everything fits into one
+ * run, nothing is written. The sort is stable: entries that compare equal come out in the order they were added.
+ *
+ * Temporary pages are deleted as soon as they are read, and the ones left over when the sorter is destroyed early.
+ */
+template <typename T, typename Less>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable_v<T>, "entries are copied to and from pages as raw bytes");
+
+ public:
+  /** Entries that fit into one temporary page. */
+  static constexpr size_t ENTRIES_PER_PAGE = BUSTUB_PAGE_SIZE / sizeof(T);
+
+  ExternalSorter(BufferPoolManager *bpm, Less less, size_t run_size)
+      : bpm_(bpm), less_(std::move(less)), run_size_(std::max(run_size, ENTRIES_PER_PAGE)) {
+    buffer_.reserve(run_size_);
+  }
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      run.Free(bpm_);
+    }
+    for (auto &run : merging_) {
+      run.Free(bpm_);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /** Add an entry. Must not be called after Finish(). */
+  void Add(const T &entry) {
+    BUSTUB_ASSERT(!finished_, "entries can't be added after Finish()");
+    if (buffer_.size() == run_size_) {
+      SpillBuffer();
+    }
+    buffer_.push_back(entry);
+  }
+
+  /** Sort what was added and merge the runs down to one merge pass, whose output Next() returns. */
+  void Finish() {
+    finished_ = true;
+    if (runs_.empty()) {
+      // 全都在内存里, 不用落盘
+      std::stable_sort(buffer_.begin(), buffer_.end(), less_);
+      return;
+    }
+    if (!buffer_.empty()) {
+      SpillBuffer();
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    size_t fan_in = std::max<size_t>(2, bpm_->GetPoolSize() / 4);
+    while (runs_.size() > fan_in) {
+      // 相邻的run分组归并, 保持先后顺序, 这样排序仍然是稳定的
+      std::vector<Run> merged;
+      for (size_t first = 0; first < runs_.size(); first += fan_in) {
+        size_t last = std::min(first + fan_in, runs_.size());
+        if (last - first == 1) {
+          merged.push_back(std::move(runs_[first]));
+          continue;
+        }
+        std::vector<Run> group(std::make_move_iterator(runs_.begin() + first),
+                               std::make_move_iterator(runs_.begin() + last));
+        StartMerge(std::move(group));
+        Run out;
+        T entry;
+        while (NextMerged(&entry)) {
+          out.Append(bpm_, entry);
+        }
+        out.Flush();
+        merged.push_back(std::move(out));
+      }
+      runs_ = std::move(merged);
+    }
+    StartMerge(std::move(runs_));
+    runs_.clear();
+  }
+
+  /** @return false after the last entry, otherwise copy the next entry in sorted order to entry */
+  auto Next(T *entry) -> bool {
+    BUSTUB_ASSERT(finished_, "Finish() must be called before Next()");
+    if (merging_.empty()) {
+      if (next_ == buffer_.size()) {
+        return false;
+      }
+      *entry = buffer_[next_++];
+      return true;
+    }
+    return NextMerged(entry);
+  }
+
+ private:
+  /** A sorted run: the temporary pages it is stored in, read front to back. */
+  struct Run {
+    std::vector<page_id_t> pages_;
+    size_t size_{0};
+    /** Position of the next entry to read. */
+    size_t read_{0};
+    /** The page being written or read. */
+    WritePageGuard write_guard_;
+    ReadPageGuard read_guard_;
+
+    void Append(BufferPoolManager *bpm, const T &entry) {
+      size_t slot = size_ % ENTRIES_PER_PAGE;
+      if (slot == 0) {
+        page_id_t page_id;
+        write_guard_ = bpm->NewWriteGuarded(&page_id);
+        pages_.push_back(page_id);
+      }
+      memcpy(write_guard_.GetDataMut() + slot * sizeof(T), &entry, sizeof(T));
+      size_++;
+    }
+
+    void Flush() { write_guard_.Drop(); }
+
+    auto Read(BufferPoolManager *bpm, T *entry) -> bool {
+      if (read_ == size_) {
+        return false;
+      }
+      size_t slot = read_ % ENTRIES_PER_PAGE;
+      if (slot == 0) {
+        // 读完的页面马上删掉, 归并过程中临时页面不会越积越多
+        if (read_ > 0) {
+          read_guard_.Drop();
+          bpm->DeletePage(pages_[read_ / ENTRIES_PER_PAGE - 1]);
+        }
+        read_guard_ = bpm->FetchPageRead(pages_[read_ / ENTRIES_PER_PAGE]);
+      }
+      memcpy(entry, read_guard_.GetData() + slot * sizeof(T), sizeof(T));
+      read_++;
+      return true;
+    }
+
+    /** Delete the pages that were not read yet, including the one being read. */
+    void Free(BufferPoolManager *bpm) {
+      write_guard_.Drop();
+      read_guard_.Drop();
+      size_t first = read_ == 0 ? 0 : (read_ - 1) / ENTRIES_PER_PAGE;
+      for (size_t i = first; i < pages_.size(); ++i) {
+        bpm->DeletePage(pages_[i]);
+      }
+      pages_.clear();
+      read_ = size_ = 0;
+    }
+  };
+
+  /** The head of a run in the merge heap. */
+  struct Head {
+    T entry_;
+    size_t run_;
+  };
+
+  void SpillBuffer() {
+    std::stable_sort(buffer_.begin(), buffer_.end(), less_);
+    Run run;
+    for (const auto &entry : buffer_) {
+      run.Append(bpm_, entry);
+    }
+    run.Flush();
+    runs_.push_back(std::move(run));
+    buffer_.clear();
+  }
+
+  void StartMerge(std::vector<Run> runs) {
+    for (auto &run : merging_) {
+      run.Free(bpm_);
+    }
+    merging_ = std::move(runs);
+    // 堆顶是最小的key, key相等时是靠前的run, 保证稳定
+    auto greater = [this](const Head &a, const Head &b) {
+      if (less_(b.entry_, a.entry_)) {
+        return true;
+      }
+      return !less_(a.entry_, b.entry_) && a.run_ > b.run_;
+    };
+    heap_ = std::priority_queue<Head, std::vector<Head>, std::function<bool(const Head &, const Head &)>>(greater);
+    for (size_t i = 0; i < merging_.size(); ++i) {
+      Head head{T{}, i};
+      if (merging_[i].Read(bpm_, &head.entry_)) {
+        heap_.push(head);
+      }
+    }
+  }
+
+  auto NextMerged(T *entry) -> bool {
+    if (heap_.empty()) {
+      for (auto &run : merging_) {
+        run.Free(bpm_);
+      }
+      merging_.clear();
+      return false;
+    }
+    Head head = heap_.top();
+    heap_.pop();
+    *entry = head.entry_;
+    if (merging_[head.run_].Read(bpm_, &head.entry_)) {
+      heap_.push(head);
+    }
+    return true;
+  }
+
+  BufferPoolManager *bpm_;
+  Less less_;
+  size_t run_size_;
+  bool finished_{false};
+  /** The run being collected; all entries if there is only one run. */
+  std::vector<T> buffer_;
+  /** Position of the next entry of buffer_ for Next(). */
+  size_t next_{0};
+  /** Runs written to temporary pages. */
+  std::vector<Run> runs_;
+  /** Runs being merged and their heads. */
+  std::vector<Run> merging_;
+  std::priority_queue<Head, std::vector<Head>, std::function<bool(const Head &, const Head &)>> heap_;
+};
+
+}  // namespace bustub
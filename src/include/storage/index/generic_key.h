@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
 
+#include "common/exception.h"
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
-#include "type/value.h"
 
 namespace bustub {
 
@@ -24,43 +26,47 @@ namespace bustub {
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
- * with a template argument.
+ * with a template argument. The data is the key as encoded by KeyEncoder,
+ * zero-padded, so keys compare by their bytes.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  /** @param tuple a key built by Tuple::KeyFromTuple, whose data is already encoded */
+  inline void SetFromKey(const Tuple &tuple) { SetFromData(tuple.GetData(), tuple.GetLength()); }
+
+  /** @param data a key encoded by KeyEncoder, or the encoding of the first columns of a key, of size bytes */
+  inline void SetFromData(const char *data, uint32_t size) {
+    if (size > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "index key is longer than the key size of the index");
+    }
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    memcpy(data_, data, size);
   }
 
   // NOTE: for test purpose only
+  // the key is a single BIGINT
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
-  }
-
-  inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+    uint64_t encoded = KeyEncoder::EncodeBigInt(key);
+    for (size_t i = 0; i < sizeof(encoded); ++i) {
+      data_[i] = static_cast<char>(encoded >> (56 - 8 * i));
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the first 8 bytes as a BIGINT
+  inline auto ToString() const -> int64_t {
+    uint64_t encoded = 0;
+    for (size_t i = 0; i < sizeof(encoded); ++i) {
+      encoded = (encoded << 8) | static_cast<uint8_t>(data_[i]);
+    }
+    return KeyEncoder::DecodeBigInt(encoded);
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the first 8 bytes as a BIGINT
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -72,35 +78,49 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are encoded so that their bytes compare like the keys. The bytes are compared 8 at a time as big-endian
+ * integers, which for a key of a single BIGINT or INTEGER is one integer comparison.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+    if constexpr (KeySize % sizeof(uint64_t) == 0) {
+      for (size_t i = 0; i < KeySize; i += sizeof(uint64_t)) {
+        uint64_t l = LoadBigEndian<uint64_t>(lhs.data_ + i);
+        uint64_t r = LoadBigEndian<uint64_t>(rhs.data_ + i);
+        if (l != r) {
+          return l < r ? -1 : 1;
+        }
       }
+      return 0;
+    } else if constexpr (KeySize == sizeof(uint32_t)) {
+      uint32_t l = LoadBigEndian<uint32_t>(lhs.data_);
+      uint32_t r = LoadBigEndian<uint32_t>(rhs.data_);
+      return l == r ? 0 : (l < r ? -1 : 1);
+    } else {
+      int diff = memcmp(lhs.data_, rhs.data_, KeySize);
+      return diff == 0 ? 0 : (diff < 0 ? -1 : 1);
     }
-    // equals
-    return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) = default;
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  // constructor. The key schema is not needed to compare encoded keys, it is only taken to build indexes as before.
+  explicit GenericComparator([[maybe_unused]] Schema *key_schema) {}
 
  private:
-  Schema *key_schema_;
+  template <typename T>
+  static inline auto LoadBigEndian(const char *data) -> T {
+    T v;
+    memcpy(&v, data, sizeof(T));
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+      return __builtin_bswap64(v);
+    } else {
+      return __builtin_bswap32(v);
+    }
+  }
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -176,6 +177,22 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for the keys within a range, in key order. The bounds are prefixes of keys encoded by
+   * KeyEncoder; a key is compared with a bound by its first bytes only, and an empty bound leaves that side open.
+   * @param lower The lower bound
+   * @param lower_inclusive Whether keys that start with lower are in the range
+   * @param upper The upper bound
+   * @param upper_inclusive Whether keys that start with upper are in the range
+   * @param result The collection of RIDs that is populated with results of the search
+   * @param transaction The transaction context
+   */
+  virtual void ScanRange([[maybe_unused]] const std::vector<char> &lower, [[maybe_unused]] bool lower_inclusive,
+                         [[maybe_unused]] const std::vector<char> &upper, [[maybe_unused]] bool upper_inclusive,
+                         [[maybe_unused]] std::vector<RID> *result, [[maybe_unused]] Transaction *transaction) {
+    throw NotImplementedException("range scan is not supported by this index");
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
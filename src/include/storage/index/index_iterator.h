@@ -49,6 +49,8 @@ class IndexIterator {
   ReadPageGuard rpg_;
   const LeafPage *page_;
   int pos_;
+  // the entry operator*() returns
+  MappingType item_;
 };
 
 }  // namespace bustub
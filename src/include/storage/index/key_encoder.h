@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * KeyEncoder turns index keys into byte strings that compare, byte by byte with memcmp, like the keys themselves. Keys
+ * are encoded once when they are built (Tuple::KeyFromTuple), so an index compares them without deserializing Values.
+ * The columns of a key are encoded one after another:
+ *
+ * - integers and booleans are stored big-endian with the sign bit flipped, so negative numbers come first. Their NULL
+ *   is the smallest value of the type and so comes first as well.
+ * - timestamps are unsigned and stored big-endian plus one, which turns NULL, the largest timestamp, into 0.
+ * - decimals are stored as the bits of the double, big-endian, with the sign bit flipped for positive numbers and all
+ *   bits flipped for negative ones. The NULL decimal is the lowest double.
+ * - varchars start with a marker byte, 0 for NULL and 1 otherwise, followed by the characters with every 0 byte
+ *   escaped as 0 0xFF and a 0 0 terminator, so a string sorts before all strings it is a prefix of.
+ */
+class KeyEncoder {
+ public:
+  /** Append the encoding of value to key. */
+  static void Encode(const Value &value, std::vector<char> *key);
+
+  /**
+   * @return the length of the longest key of key_schema whose varchars hold no 0 bytes. SQL strings can't hold them,
+   * and a key that grows past the key size of its index through escaping is rejected (see GenericKey::SetFromData).
+   */
+  static auto MaxSize(const Schema &key_schema) -> size_t;
+
+  /** @return the encoding of a BIGINT, as an integer whose big-endian bytes are the encoding */
+  static auto EncodeBigInt(int64_t value) -> uint64_t { return static_cast<uint64_t>(value) ^ (UINT64_C(1) << 63); }
+
+  /** @return the BIGINT encoded by EncodeBigInt() */
+  static auto DecodeBigInt(uint64_t encoded) -> int64_t { return static_cast<int64_t>(encoded ^ (UINT64_C(1) << 63)); }
+};
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * KeySearch finds keys within a B+ tree page, whose keys are stored in one sorted, contiguous array. Binary search
+ * narrows the range down to SIMD_WINDOW keys, which are then compared all at once. Keys of 4 and 8 bytes are encoded
+ * integers (see KeyEncoder) and are compared several per instruction with AVX2 or SSE4.2, whichever the CPU supports;
+ * other keys, and CPUs without either, compare one key at a time.
+ */
+class KeySearch {
+ public:
+  /** The number of keys that binary search leaves for the SIMD comparison. */
+  static constexpr int SIMD_WINDOW = 16;
+
+  enum class Isa { SCALAR, SSE42, AVX2 };
+
+  /**
+   * @return the number of keys in keys[0, n) that are less than key, or less than or equal to key if inclusive. The
+   * keys are 8-byte encoded keys in ascending order.
+   */
+  static auto Count64(const char *keys, int n, const char *key, bool inclusive) -> int {
+    return count64_(keys, n, key, inclusive);
+  }
+
+  /** The same as Count64() for 4-byte keys. */
+  static auto Count32(const char *keys, int n, const char *key, bool inclusive) -> int {
+    return count32_(keys, n, key, inclusive);
+  }
+
+  /** @return the instruction set the searches use, the best the CPU supports unless Use() picked another */
+  static auto GetIsa() -> Isa { return isa_; }
+
+  /** Search with the given instruction set, for tests and benchmarks. @return false if the CPU doesn't support it */
+  static auto Use(Isa isa) -> bool;
+
+  /**
+   * @return the position of the first key in keys[begin, end) that is greater than or equal to key, or greater than key
+   * if inclusive; end if there is none
+   */
+  template <typename KeyType, typename KeyComparator>
+  static auto Search(const KeyType *keys, int begin, int end, const KeyType &key, const KeyComparator &comparator,
+                     bool inclusive) -> int {
+    while (end - begin > SIMD_WINDOW) {
+      int mid = begin + (end - begin) / 2;
+      int diff = comparator(keys[mid], key);
+      if (diff < 0 || (inclusive && diff == 0)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    if constexpr (std::is_same_v<KeyType, GenericKey<8>> && std::is_same_v<KeyComparator, GenericComparator<8>>) {
+      return begin + Count64(keys[begin].data_, end - begin, key.data_, inclusive);
+    } else if constexpr (std::is_same_v<KeyType, GenericKey<4>> &&
+                         std::is_same_v<KeyComparator, GenericComparator<4>>) {
+      return begin + Count32(keys[begin].data_, end - begin, key.data_, inclusive);
+    } else {
+      while (begin < end) {
+        int diff = comparator(keys[begin], key);
+        if (diff > 0 || (!inclusive && diff == 0)) {
+          break;
+        }
+        begin++;
+      }
+      return begin;
+    }
+  }
+
+ private:
+  using CountFunc = int (*)(const char *, int, const char *, bool);
+
+  static Isa isa_;
+  static CountFunc count64_;
+  static CountFunc count32_;
+};
+
+}  // namespace bustub
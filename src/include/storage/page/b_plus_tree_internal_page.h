@@ -19,8 +19,9 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 20
+#define INTERNAL_PAGE_SIZE \
+  ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(KeyType)) / (sizeof(KeyType) + sizeof(ValueType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -29,10 +30,16 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Internal page format (keys are stored in increasing order). Like in leaf
+ * pages, the keys are stored apart from the page ids, which start after room
+ * for INTERNAL_PAGE_SIZE keys:
+ *  -------------------------------------------------------------------------------------
+ * | HEADER | HIGH KEY | KEY(1) | ... | KEY(n) | ... | PAGE_ID(1) | ... | PAGE_ID(n) |
+ *  -------------------------------------------------------------------------------------
+ *
+ * The header and the high key are laid out as in leaf pages: all keys in the
+ * subtrees of the page are less than the high key, which is only set if the
+ * page has a next page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -48,6 +55,9 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Init(int max_size = INTERNAL_PAGE_SIZE);
 
+  auto GetHighKey() const -> const KeyType & { return high_key_; }
+  void SetHighKey(const KeyType &key) { high_key_ = key; }
+
   /**
    * @param index The index of the key to get. Index must be non-zero.
    * @return Key at index
@@ -75,7 +85,20 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto ValueAt(int index) const -> ValueType;
 
   // NOTE:
-  auto SetValueAt(int index, page_id_t value) { array_[index].second = value; }
+  auto SetValueAt(int index, page_id_t value) { Values()[index] = value; }
+
+  /**
+   * @param key the key to search for
+   * @param comparator the comparator of the tree
+   * @return the index of the child whose subtree holds key
+   */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * Copy the header, the high key and the first size entries of the internal page at src to dst, which must have room for a page.
+   * @return dst as an internal page
+   */
+  static auto CopyEntries(char *dst, const char *src, int size) -> const BPlusTreeInternalPage *;
   /**
    * @brief For test only, return a string representing all keys in
    * this internal page, formatted as "(key1,key2,key3,...)"
@@ -103,7 +126,15 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  auto Keys() const -> const KeyType * { return reinterpret_cast<const KeyType *>(data_); }
+  auto Keys() -> KeyType * { return reinterpret_cast<KeyType *>(data_); }
+  auto Values() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(data_ + INTERNAL_PAGE_SIZE * sizeof(KeyType));
+  }
+  auto Values() -> ValueType * { return reinterpret_cast<ValueType *>(data_ + INTERNAL_PAGE_SIZE * sizeof(KeyType)); }
+
+  KeyType high_key_;
   // Flexible array member for page data.
-  MappingType array_[0];
+  char data_[0];
 };
 }  // namespace bustub
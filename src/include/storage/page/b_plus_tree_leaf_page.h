@@ -19,26 +19,32 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 20
+#define LEAF_PAGE_SIZE \
+  ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / (sizeof(KeyType) + sizeof(ValueType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * Leaf page format (keys are stored in order). The keys are stored apart from
+ * the rids, so a search only reads the keys and compares several at a time
+ * (see KeySearch). The rids start after room for LEAF_PAGE_SIZE keys:
+ *  -----------------------------------------------------------------------------------
+ * | HEADER | HIGH KEY | KEY(1) | KEY(2) | ... | KEY(n) | ... | RID(1) | ... | RID(n)
+ *  -----------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 20 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * |  NextPageId (4)
+ * |  NextPageId (4) | Level (4)
  *  -----------------------------------------------
+ *
+ * All keys of the page are less than the high key, which is only set if the
+ * page has a next page. The keys of the next page are not less than it.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -55,14 +61,20 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void Init(int max_size = LEAF_PAGE_SIZE);
 
   // helper methods
-  auto GetNextPageId() const -> page_id_t;
-  void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> const KeyType & { return high_key_; }
+  void SetHighKey(const KeyType &key) { high_key_ = key; }
   auto KeyAt(int index) const -> KeyType;
-  auto ValueAt(int index) const -> ValueType { return array_[index].second; }
+  auto ValueAt(int index) const -> ValueType { return Values()[index]; }
+
+  auto SetKeyAt(int index, const KeyType &key) { Keys()[index] = key; }
+  auto SetValueAt(int index, ValueType value) { Values()[index] = value; }
 
-  auto SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
-  auto SetValueAt(int index, ValueType value) { array_[index].second = value; }
-  auto PairAt(int index) const -> const MappingType & { return array_[index]; }
+  /**
+   * @param key the key to search for
+   * @param comparator the comparator of the tree
+   * @return the index of the first key that is not less than key, GetSize() if there is none
+   */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
   /**
    * @brief for test only return a string representing all keys in
    * this leaf page formatted as "(key1,key2,key3,...)"
@@ -89,8 +101,15 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   }
 
  private:
-  page_id_t next_page_id_;
+  auto Keys() const -> const KeyType * { return reinterpret_cast<const KeyType *>(data_); }
+  auto Keys() -> KeyType * { return reinterpret_cast<KeyType *>(data_); }
+  auto Values() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(data_ + LEAF_PAGE_SIZE * sizeof(KeyType));
+  }
+  auto Values() -> ValueType * { return reinterpret_cast<ValueType *>(data_ + LEAF_PAGE_SIZE * sizeof(KeyType)); }
+
+  KeyType high_key_;
   // Flexible array member for page data.
-  MappingType array_[0];
+  char data_[0];
 };
 }  // namespace bustub
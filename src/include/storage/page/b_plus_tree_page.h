@@ -33,10 +33,14 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 12 bytes in total):
+ * Header format (size in byte, 20 bytes in total):
  * ----------------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) |
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | NextPageId (4) | Level (4) |
  * ----------------------------------------------------------------------------
+ *
+ * Every page links to its right sibling on the same level (NextPageId), so a
+ * split is visible from the left page before the parent knows about the new
+ * page (see BPlusTree::Insert). Leaves are on level 0.
  */
 class BPlusTreePage {
  public:
@@ -57,11 +61,19 @@ class BPlusTreePage {
   void SetMaxSize(int max_size);
   auto GetMinSize() const -> int;
 
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  auto GetLevel() const -> int { return level_; }
+  void SetLevel(int level) { level_ = level; }
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
   int size_ __attribute__((__unused__));
   int max_size_ __attribute__((__unused__));
+  page_id_t next_page_id_;
+  int level_;
 };
 
 }  // namespace bustub
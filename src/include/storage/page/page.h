@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,8 +25,11 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * Pages are cache-line aligned, so the book-keeping of neighbouring frames in the buffer pool's frame array never
+ * shares a cache line.
  */
-class Page {
+class alignas(BUSTUB_CACHELINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
@@ -36,8 +40,20 @@ class Page {
     ResetMemory();
   }
 
+  /**
+   * Constructor for a frame whose data is owned by someone else, e.g. the buffer pool's frame arena. The data is
+   * neither zeroed nor freed by the page.
+   * @param data BUSTUB_PAGE_SIZE bytes of page data
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+    delete[] swips_.load();
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -51,11 +67,17 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. Makes the version of the page odd. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -63,6 +85,23 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page, for optimistic reads. It is odd while a writer holds the write latch, and changes
+   * whenever the write latch is released or the frame is reused for another page.
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Validate an optimistic read of the page data.
+   * @param version the version read before the page data was read
+   * @return true if the page has not been written to and its frame has not been reused since
+   */
+  inline auto CheckVersion(uint64_t version) -> bool {
+    // 之前对页面数据的读不能被重排到版本号检查之后
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -85,12 +124,20 @@ class Page {
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** False if data_ is borrowed, see Page(char *). */
+  bool owns_data_{true};
+  /** The ID of this page. Atomic, since the buffer pool reads it without a latch to validate a lock-free pin. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. -1 while the buffer pool claims the frame for eviction. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** False while the page data is still being read from disk. */
+  std::atomic<bool> is_loaded_{true};
+  /** Version for optimistic reads, see GetVersion(). */
+  std::atomic<uint64_t> version_{0};
+  /** Frame hints of the children of this page, allocated on first use. See BufferPoolManager::FetchChildRead(). */
+  std::atomic<std::atomic<frame_id_t> *> swips_{nullptr};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -79,6 +79,7 @@ class BasicPageGuard {
   }
 
  private:
+  friend class BufferPoolManager;
   friend class ReadPageGuard;
   friend class WritePageGuard;
 
@@ -143,6 +144,8 @@ class ReadPageGuard {
   }
 
  private:
+  friend class BufferPoolManager;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
@@ -210,8 +213,50 @@ class WritePageGuard {
   }
 
  private:
+  friend class BufferPoolManager;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticReadGuard gives access to a page without pinning or latching it. It only remembers the version the page had
+ * when the guard was taken, so it is cheap to take and never blocks a writer. In exchange anything read through it may
+ * be inconsistent, or even belong to another page if the frame was reused: it can only be trusted once Validate()
+ * returns true afterwards, and sizes or offsets read from the page must be bounds-checked before they are used.
+ * Writers are only noticed if they hold the page's write latch.
+ */
+class OptimisticReadGuard {
+ public:
+  OptimisticReadGuard() = default;
+  OptimisticReadGuard(Page *page, page_id_t page_id, uint64_t version)
+      : page_(page), page_id_(page_id), version_(version) {}
+
+  auto PageId() const -> page_id_t { return page_id_; }
+
+  /** @return the page data, nullptr if the guard does not hold a page */
+  auto GetData() const -> const char * { return page_ == nullptr ? nullptr : page_->GetData(); }
+
+  template <class T>
+  auto As() const -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return true if the page has not been changed since the guard was taken, i.e. everything read so far is valid */
+  auto Validate() const -> bool { return page_ != nullptr && page_->CheckVersion(version_); }
+
+  /**
+   * @return true if the page has not been changed before the caller took its write latch. Taking the write latch
+   * bumps the version once, so only a version one past the guard's means nobody else wrote the page in between.
+   */
+  auto ValidateWriteLatched() const -> bool { return page_ != nullptr && page_->CheckVersion(version_ + 1); }
+
+ private:
+  friend class BufferPoolManager;
+
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
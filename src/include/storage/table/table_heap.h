@@ -15,6 +15,7 @@
 #include <mutex>  // NOLINT
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/config.h"
@@ -29,7 +30,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. The ids of the pages are also kept in memory in list order, so a scan
+ * knows the pages ahead of it without reading them.
  */
 class TableHeap {
   friend class TableIterator;
@@ -63,9 +65,10 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is accessed, AccessType::Scan for sequential scans
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
@@ -84,6 +87,12 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * @param idx position of the page in the page list, the first page is at 0
+   * @return the id of the page at that position, or INVALID_PAGE_ID if the table has fewer pages
+   */
+  auto GetPageIdAt(size_t idx) -> page_id_t;
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -98,6 +107,7 @@ class TableHeap {
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  std::vector<page_id_t> page_ids_;         /* protected by latch_ */
 };
 
 }  // namespace bustub
@@ -27,6 +27,10 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * Pages are fetched with AccessType::Scan. While the iterator is on a page, the next `scan_prefetch_window` pages of
+ * the table are prefetched into the buffer pool, so moving on to the next page does not wait for a disk read. The
+ * page metadata the iterator needs (tuple count, next page) is read optimistically, without pinning or latching.
  */
 class TableIterator {
   friend class Cursor;
@@ -51,13 +55,26 @@ class TableIterator {
     table_heap_ = iter.table_heap_;
     rid_ = iter.rid_;
     stop_at_rid_ = iter.stop_at_rid_;
+    page_idx_ = iter.page_idx_;
+    prefetched_until_ = iter.prefetched_until_;
     return *this;
   }
 
  private:
+  /** Prefetch the pages in the window after the current page that have not been prefetched yet. */
+  void Prefetch();
+
+  /** Read the tuple count and the next page id of a page with an optimistic read of the page. */
+  void ReadPageMeta(page_id_t page_id, uint32_t *num_tuples, page_id_t *next_page_id);
+
   TableHeap *table_heap_;
   RID rid_;
 
+  /** Position of the current page in the page list of the table. */
+  size_t page_idx_{0};
+  /** Pages before this position have already been prefetched. */
+  size_t prefetched_until_{1};
+
   // When creating table iterator, we will record the maximum RID that we should scan.
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
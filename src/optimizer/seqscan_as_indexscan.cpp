@@ -0,0 +1,189 @@
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** The range a column is restricted to by the conjuncts of a predicate. */
+struct ColumnRange {
+  std::optional<Value> equal_;
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+};
+
+/** @return true if the bound (value, inclusive) excludes more than (other, other_inclusive) on the lower side */
+auto TighterLower(const Value &value, bool inclusive, const Value &other, bool other_inclusive) -> bool {
+  if (value.CompareGreaterThan(other) == CmpBool::CmpTrue) {
+    return true;
+  }
+  return value.CompareEquals(other) == CmpBool::CmpTrue && !inclusive && other_inclusive;
+}
+
+auto TighterUpper(const Value &value, bool inclusive, const Value &other, bool other_inclusive) -> bool {
+  if (value.CompareLessThan(other) == CmpBool::CmpTrue) {
+    return true;
+  }
+  return value.CompareEquals(other) == CmpBool::CmpTrue && !inclusive && other_inclusive;
+}
+
+/** Narrow the ranges of the columns by the `column op constant` comparisons among the conjuncts of expr. */
+void CollectRanges(const AbstractExpressionRef &expr, std::vector<ColumnRange> *ranges) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get()); logic != nullptr) {
+    if (logic->logic_type_ == LogicType::And) {
+      CollectRanges(logic->GetChildAt(0), ranges);
+      CollectRanges(logic->GetChildAt(1), ranges);
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comparison == nullptr) {
+    return;
+  }
+  auto comp_type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr || constant == nullptr) {
+    // 常量在左边, 比较反过来
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  // 常量的类型要和列一样, 编码出来的上下界才和索引的key一致
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 || constant->val_.IsNull() ||
+      constant->val_.GetTypeId() != column->GetReturnType()) {
+    return;
+  }
+  auto &range = (*ranges)[column->GetColIdx()];
+  const auto &value = constant->val_;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      if (!range.equal_.has_value()) {
+        range.equal_ = value;
+      }
+      break;
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual: {
+      bool inclusive = comp_type == ComparisonType::GreaterThanOrEqual;
+      if (!range.lower_.has_value() || TighterLower(value, inclusive, *range.lower_, range.lower_inclusive_)) {
+        range.lower_ = value;
+        range.lower_inclusive_ = inclusive;
+      }
+      break;
+    }
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual: {
+      bool inclusive = comp_type == ComparisonType::LessThanOrEqual;
+      if (!range.upper_.has_value() || TighterUpper(value, inclusive, *range.upper_, range.upper_inclusive_)) {
+        range.upper_ = value;
+        range.upper_inclusive_ = inclusive;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeSeqScanAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // 增删改下面的扫描不动: 删除和更新要在扫描的时候给行加写锁, 而且不能一边扫索引一边改索引
+  if (plan->GetType() == PlanType::Insert || plan->GetType() == PlanType::Delete ||
+      plan->GetType() == PlanType::Update) {
+    return plan;
+  }
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeSeqScanAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*optimized_plan);
+  if (seq_scan.filter_predicate_ == nullptr) {
+    return optimized_plan;
+  }
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+  std::vector<ColumnRange> ranges(table_info->schema_.GetColumnCount());
+  CollectRanges(seq_scan.filter_predicate_, &ranges);
+
+  // 选能限定住的key列最多的索引: 前面的列相等, 最后一列可以是范围
+  const IndexInfo *best_index = nullptr;
+  size_t best_columns = 0;
+  std::vector<Value> best_lower;
+  std::vector<Value> best_upper;
+  bool best_lower_inclusive = true;
+  bool best_upper_inclusive = true;
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    std::vector<Value> lower;
+    std::vector<Value> upper;
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+    for (auto attr : index->index_->GetKeyAttrs()) {
+      const auto &range = ranges[attr];
+      if (range.equal_.has_value()) {
+        lower.push_back(*range.equal_);
+        upper.push_back(*range.equal_);
+        continue;
+      }
+      if (range.lower_.has_value()) {
+        lower.push_back(*range.lower_);
+        lower_inclusive = range.lower_inclusive_;
+      }
+      if (range.upper_.has_value()) {
+        upper.push_back(*range.upper_);
+        upper_inclusive = range.upper_inclusive_;
+      }
+      break;
+    }
+    size_t columns = lower.size() + upper.size();
+    if (columns > best_columns) {
+      best_index = index;
+      best_columns = columns;
+      best_lower = std::move(lower);
+      best_upper = std::move(upper);
+      best_lower_inclusive = lower_inclusive;
+      best_upper_inclusive = upper_inclusive;
+    }
+  }
+  if (best_index == nullptr) {
+    return optimized_plan;
+  }
+  // 整个谓词还是要在扫描的时候检查, 范围只是少扫一些key
+  return std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, best_index->index_oid_, seq_scan.filter_predicate_,
+                                             std::move(best_lower), best_lower_inclusive, std::move(best_upper),
+                                             best_upper_inclusive);
+}
+
+}  // namespace bustub
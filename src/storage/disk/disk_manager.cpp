@@ -11,7 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -20,12 +23,22 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Header of the free space map file, followed by the bitmap. */
+struct FreeSpaceMapHeader {
+  uint64_t magic_;
+  uint64_t num_pages_;
+};
+
+static constexpr uint64_t FREE_SPACE_MAP_MAGIC = 0x70614d6563617053;  // "SpaceMap"
+static constexpr size_t BITS_PER_WORD = 64;
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
@@ -37,6 +50,7 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -61,12 +75,15 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
   buffer_used = nullptr;
+  int file_size = GetFileSize(file_name_);
+  LoadFreeSpaceMap(file_size <= 0 ? 0 : (file_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  SaveFreeSpaceMap();
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
@@ -93,6 +110,44 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   db_io_.flush();
 }
 
+/**
+ * Write the contents of consecutive pages into disk file, with one seek and one flush
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  size_t offset = static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += num_pages;
+  db_io_.seekp(offset);
+  db_io_.write(pages_data, num_pages * BUSTUB_PAGE_SIZE);
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  db_io_.flush();
+}
+
+/**
+ * Run a batch synchronously, in submission order
+ */
+void DiskManager::ExecuteBatch(const std::vector<DiskIO> &ios,
+                               const std::function<void(size_t, std::exception_ptr)> &on_complete) {
+  for (size_t i = 0; i < ios.size(); i++) {
+    const auto &io = ios[i];
+    try {
+      if (io.is_write_ && io.num_pages_ > 1) {
+        WritePages(io.page_id_, io.data_, io.num_pages_);
+      } else if (io.is_write_) {
+        WritePage(io.page_id_, io.data_);
+      } else {
+        ReadPage(io.page_id_, io.data_);
+      }
+      on_complete(i, nullptr);
+    } catch (...) {
+      on_complete(i, std::current_exception());
+    }
+  }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
@@ -184,6 +239,177 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Hand out the lowest free page of the partition, or grow the file
+ */
+auto DiskManager::AllocatePage(size_t num_partitions, size_t partition) -> page_id_t {
+  BUSTUB_ASSERT(partition < num_partitions, "partition out of range");
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  fsm_dirty_ = true;
+  if (num_free_pages_ > 0) {
+    for (size_t word = first_free_word_; word < free_pages_.size(); word++) {
+      uint64_t bits = free_pages_[word];
+      if (bits == 0 && word == first_free_word_) {
+        first_free_word_++;
+      }
+      // 依次检查这个word里的空闲页, 取第一个属于这个分区的
+      for (; bits != 0; bits &= bits - 1) {
+        size_t page = word * BITS_PER_WORD + __builtin_ctzll(bits);
+        if (page % num_partitions == partition) {
+          free_pages_[word] &= ~(static_cast<uint64_t>(1) << (page % BITS_PER_WORD));
+          num_free_pages_--;
+          return static_cast<page_id_t>(page);
+        }
+      }
+    }
+  }
+  // 没有可复用的页: 文件增长到这个分区的下一个页号, 跳过的其他分区的页号记为空闲
+  size_t page = num_pages_ + (partition + num_partitions - num_pages_ % num_partitions) % num_partitions;
+  free_pages_.resize(page / BITS_PER_WORD + 1, 0);
+  first_free_word_ = std::min(first_free_word_, num_pages_ / BITS_PER_WORD);
+  for (size_t skipped = num_pages_; skipped < page; skipped++) {
+    free_pages_[skipped / BITS_PER_WORD] |= static_cast<uint64_t>(1) << (skipped % BITS_PER_WORD);
+    num_free_pages_++;
+  }
+  num_pages_ = page + 1;
+  return static_cast<page_id_t>(page);
+}
+
+/**
+ * Mark a page as free in the free space map
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return;
+  }
+  size_t word = page_id / BITS_PER_WORD;
+  uint64_t bit = static_cast<uint64_t>(1) << (page_id % BITS_PER_WORD);
+  if ((free_pages_[word] & bit) != 0) {
+    return;
+  }
+  free_pages_[word] |= bit;
+  num_free_pages_++;
+  first_free_word_ = std::min(first_free_word_, word);
+  fsm_dirty_ = true;
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return false;
+  }
+  return (free_pages_[page_id / BITS_PER_WORD] & (static_cast<uint64_t>(1) << (page_id % BITS_PER_WORD))) == 0;
+}
+
+auto DiskManager::GetNumPages() -> size_t {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  return num_pages_;
+}
+
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  return num_free_pages_;
+}
+
+/**
+ * Drop the free pages at the end of the file from the map and truncate the file after the last allocated page
+ */
+auto DiskManager::Shrink() -> size_t {
+  size_t old_num_pages;
+  {
+    std::scoped_lock scoped_fsm_latch(fsm_latch_);
+    old_num_pages = num_pages_;
+    while (num_pages_ > 0) {
+      size_t last = num_pages_ - 1;
+      uint64_t bit = static_cast<uint64_t>(1) << (last % BITS_PER_WORD);
+      if ((free_pages_[last / BITS_PER_WORD] & bit) == 0) {
+        break;
+      }
+      free_pages_[last / BITS_PER_WORD] &= ~bit;
+      num_free_pages_--;
+      num_pages_--;
+    }
+    free_pages_.resize((num_pages_ + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    first_free_word_ = std::min(first_free_word_, free_pages_.size());
+    if (num_pages_ != old_num_pages) {
+      fsm_dirty_ = true;
+    }
+    TruncateFile(num_pages_);
+  }
+  SaveFreeSpaceMap();
+  return old_num_pages - num_pages_;
+}
+
+void DiskManager::TruncateFile(size_t num_pages) {
+  if (file_name_.empty() || GetFileSize(file_name_) <= static_cast<int>(num_pages * BUSTUB_PAGE_SIZE)) {
+    return;
+  }
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.flush();
+  if (truncate(file_name_.c_str(), static_cast<off_t>(num_pages * BUSTUB_PAGE_SIZE)) != 0) {
+    throw Exception("can't truncate db file");
+  }
+}
+
+void DiskManager::LoadFreeSpaceMap(size_t num_file_pages) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  num_pages_ = num_file_pages;
+  free_pages_.assign((num_pages_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+  num_free_pages_ = 0;
+  first_free_word_ = 0;
+  if (num_file_pages == 0) {
+    // 新建的数据库文件: 之前留下的空闲页表已经没有意义
+    return;
+  }
+  std::ifstream fsm_io(fsm_name_, std::ios::binary | std::ios::in);
+  if (!fsm_io.is_open()) {
+    // 没有空闲页表: 文件里的页全部当作已分配
+    return;
+  }
+  FreeSpaceMapHeader header{};
+  fsm_io.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!fsm_io || header.magic_ != FREE_SPACE_MAP_MAGIC) {
+    LOG_WARN("ignoring invalid free space map %s", fsm_name_.c_str());
+    return;
+  }
+  std::vector<uint64_t> free_pages((header.num_pages_ + BITS_PER_WORD - 1) / BITS_PER_WORD);
+  fsm_io.read(reinterpret_cast<char *>(free_pages.data()), free_pages.size() * sizeof(uint64_t));
+  if (!fsm_io) {
+    LOG_WARN("ignoring truncated free space map %s", fsm_name_.c_str());
+    return;
+  }
+  // 文件可能比记录的更长(分配之后没来得及保存), 多出来的页当作已分配
+  num_pages_ = std::max<size_t>(num_pages_, header.num_pages_);
+  free_pages.resize((num_pages_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+  free_pages_ = std::move(free_pages);
+  for (auto word : free_pages_) {
+    num_free_pages_ += __builtin_popcountll(word);
+  }
+}
+
+void DiskManager::SaveFreeSpaceMap() {
+  if (fsm_name_.empty()) {
+    return;
+  }
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (!fsm_dirty_) {
+    return;
+  }
+  // 先写到临时文件再改名, 崩溃时不会留下写了一半的空闲页表
+  std::string tmp_name = fsm_name_ + ".tmp";
+  std::ofstream fsm_io(tmp_name, std::ios::binary | std::ios::trunc | std::ios::out);
+  FreeSpaceMapHeader header{FREE_SPACE_MAP_MAGIC, num_pages_};
+  fsm_io.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  fsm_io.write(reinterpret_cast<const char *>(free_pages_.data()), free_pages_.size() * sizeof(uint64_t));
+  fsm_io.close();
+  if (fsm_io.fail() || std::rename(tmp_name.c_str(), fsm_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing free space map");
+    return;
+  }
+  fsm_dirty_ = false;
+}
+
 /**
  * Returns number of flushes made so far
  */
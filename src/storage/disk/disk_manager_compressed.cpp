@@ -0,0 +1,362 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.cpp
+//
+// Identification: src/storage/disk/disk_manager_compressed.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_compressed.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/page_codec.h"
+
+namespace bustub {
+
+namespace {
+
+struct SlotMapHeader {
+  uint64_t magic_;
+  uint64_t num_slots_;
+};
+
+struct SlotMapEntry {
+  int32_t page_id_;
+  uint32_t size_;
+  uint32_t capacity_;
+  uint32_t reserved_;
+  uint64_t offset_;
+};
+
+constexpr uint64_t SLOT_MAP_MAGIC = 0x70614d746f6c53;  // "SlotMap"
+
+auto PwriteAll(int fd, const char *data, size_t size, uint64_t offset) -> bool {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t ret = pwrite(fd, data + written, size - written, static_cast<off_t>(offset + written));
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    written += ret;
+  }
+  return true;
+}
+
+auto PreadAll(int fd, char *data, size_t size, uint64_t offset) -> bool {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t ret = pread(fd, data + read_count, size - read_count, static_cast<off_t>(offset + read_count));
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    read_count += ret;
+  }
+  return true;
+}
+
+auto RoundUpToSlot(size_t size) -> size_t {
+  return (size + DiskManagerCompressed::SLOT_ALIGNMENT - 1) / DiskManagerCompressed::SLOT_ALIGNMENT *
+         DiskManagerCompressed::SLOT_ALIGNMENT;
+}
+
+}  // namespace
+
+/**
+ * The base constructor creates the db file and the log file; the db stream is then replaced by a raw descriptor, and
+ * the free space map is loaded again with the number of pages the slot map knows of.
+ */
+DiskManagerCompressed::DiskManagerCompressed(const std::string &db_file) : DiskManager(db_file) {
+  db_io_.close();
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  if (!fsm_name_.empty()) {
+    map_name_ = fsm_name_.substr(0, fsm_name_.size() - 4) + ".cmap";
+  }
+  LoadSlotMap();
+}
+
+DiskManagerCompressed::~DiskManagerCompressed() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void DiskManagerCompressed::ShutDown() {
+  if (fd_ >= 0) {
+    if (fdatasync(fd_) != 0) {
+      LOG_DEBUG("fdatasync failed: %s", strerror(errno));
+    }
+    SaveSlotMap();
+    close(fd_);
+    fd_ = -1;
+  }
+  DiskManager::ShutDown();
+}
+
+void DiskManagerCompressed::WritePage(page_id_t page_id, const char *page_data) {
+  // 压缩后不比原页面小就原样存储
+  char compressed[BUSTUB_PAGE_SIZE];
+  size_t size = PageCodec::Compress(page_data, BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE - 1);
+  const char *data = compressed;
+  if (size == 0) {
+    size = BUSTUB_PAGE_SIZE;
+    data = page_data;
+  }
+
+  uint64_t offset;
+  {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    num_writes_ += 1;
+    auto iter = slots_.find(page_id);
+    if (iter != slots_.end() && iter->second.capacity_ >= size) {
+      // 原来的槽位放得下就原地覆盖
+      stored_bytes_ = stored_bytes_ - iter->second.size_ + size;
+      iter->second.size_ = size;
+    } else {
+      if (iter != slots_.end()) {
+        stored_bytes_ -= iter->second.size_;
+        FreeExtent(iter->second.offset_, iter->second.capacity_);
+      }
+      size_t capacity = RoundUpToSlot(size);
+      slots_[page_id] = {AllocateExtent(capacity), static_cast<uint32_t>(size), static_cast<uint32_t>(capacity)};
+      stored_bytes_ += size;
+    }
+    offset = slots_[page_id].offset_;
+    map_dirty_ = true;
+  }
+  // 缓冲池保证同一页面的读写不会并发, 槽位在这次写完之前不会被别的页面占用
+  if (!PwriteAll(fd_, data, size, offset)) {
+    LOG_DEBUG("I/O error while writing: %s", strerror(errno));
+  }
+}
+
+void DiskManagerCompressed::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  for (size_t i = 0; i < num_pages; ++i) {
+    WritePage(first_page_id + static_cast<page_id_t>(i), pages_data + i * BUSTUB_PAGE_SIZE);
+  }
+}
+
+void DiskManagerCompressed::ReadPage(page_id_t page_id, char *page_data) {
+  Slot slot{};
+  {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    auto iter = slots_.find(page_id);
+    if (iter == slots_.end()) {
+      LOG_DEBUG("I/O error reading a page that was never written");
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+      return;
+    }
+    slot = iter->second;
+  }
+  if (slot.size_ == BUSTUB_PAGE_SIZE) {
+    if (!PreadAll(fd_, page_data, BUSTUB_PAGE_SIZE, slot.offset_)) {
+      throw Exception("can't read page from compressed db file");
+    }
+    return;
+  }
+  char compressed[BUSTUB_PAGE_SIZE];
+  if (!PreadAll(fd_, compressed, slot.size_, slot.offset_) ||
+      !PageCodec::Decompress(compressed, slot.size_, page_data, BUSTUB_PAGE_SIZE)) {
+    throw Exception("can't read page from compressed db file");
+  }
+}
+
+void DiskManagerCompressed::Sync() {
+  // 先让数据落盘, 再保存指向它们的槽位表
+  if (fd_ >= 0 && fdatasync(fd_) != 0) {
+    LOG_DEBUG("fdatasync failed: %s", strerror(errno));
+  }
+  SaveSlotMap();
+  DiskManager::Sync();
+}
+
+void DiskManagerCompressed::DeallocatePage(page_id_t page_id) {
+  DiskManager::DeallocatePage(page_id);
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  auto iter = slots_.find(page_id);
+  if (iter == slots_.end()) {
+    return;
+  }
+  stored_bytes_ -= iter->second.size_;
+  FreeExtent(iter->second.offset_, iter->second.capacity_);
+  slots_.erase(iter);
+  map_dirty_ = true;
+}
+
+auto DiskManagerCompressed::GetCompressionRatio() -> double {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  if (stored_bytes_ == 0) {
+    return 1;
+  }
+  return static_cast<double>(slots_.size() * BUSTUB_PAGE_SIZE) / static_cast<double>(stored_bytes_);
+}
+
+auto DiskManagerCompressed::GetStoredBytes() -> size_t {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  return stored_bytes_;
+}
+
+auto DiskManagerCompressed::GetFileBytes() -> size_t {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  return file_end_;
+}
+
+void DiskManagerCompressed::TruncateFile(size_t num_pages) {
+  {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    for (auto iter = slots_.begin(); iter != slots_.end();) {
+      if (static_cast<size_t>(iter->first) < num_pages) {
+        ++iter;
+        continue;
+      }
+      stored_bytes_ -= iter->second.size_;
+      FreeExtent(iter->second.offset_, iter->second.capacity_);
+      iter = slots_.erase(iter);
+      map_dirty_ = true;
+    }
+    if (ftruncate(fd_, static_cast<off_t>(file_end_)) != 0) {
+      throw Exception("can't truncate db file");
+    }
+  }
+  SaveSlotMap();
+}
+
+auto DiskManagerCompressed::AllocateExtent(size_t size) -> uint64_t {
+  auto iter = free_extents_by_size_.lower_bound(size);
+  if (iter == free_extents_by_size_.end()) {
+    uint64_t offset = file_end_;
+    file_end_ += size;
+    return offset;
+  }
+  // 放进最小的够大的空闲区间, 剩下的部分仍然空闲
+  uint64_t extent_size = iter->first;
+  uint64_t offset = iter->second;
+  free_extents_by_size_.erase(iter);
+  free_extents_.erase(offset);
+  if (extent_size > size) {
+    free_extents_[offset + size] = extent_size - size;
+    free_extents_by_size_.emplace(extent_size - size, offset + size);
+  }
+  return offset;
+}
+
+void DiskManagerCompressed::FreeExtent(uint64_t offset, size_t size) {
+  auto erase_by_size = [this](uint64_t extent_offset, uint64_t extent_size) {
+    auto [begin, end] = free_extents_by_size_.equal_range(extent_size);
+    for (auto iter = begin; iter != end; ++iter) {
+      if (iter->second == extent_offset) {
+        free_extents_by_size_.erase(iter);
+        return;
+      }
+    }
+  };
+  // 和前后相邻的空闲区间合并
+  auto next = free_extents_.lower_bound(offset);
+  if (next != free_extents_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      erase_by_size(prev->first, prev->second);
+      offset = prev->first;
+      size += prev->second;
+      free_extents_.erase(prev);
+    }
+  }
+  if (next != free_extents_.end() && offset + size == next->first) {
+    erase_by_size(next->first, next->second);
+    size += next->second;
+    free_extents_.erase(next);
+  }
+  if (offset + size == file_end_) {
+    file_end_ = offset;
+    return;
+  }
+  free_extents_[offset] = size;
+  free_extents_by_size_.emplace(size, offset);
+}
+
+void DiskManagerCompressed::LoadSlotMap() {
+  struct stat st {};
+  if (fstat(fd_, &st) != 0 || st.st_size == 0) {
+    // 新建的数据库文件
+    LoadFreeSpaceMap(0);
+    return;
+  }
+  std::ifstream map_io(map_name_, std::ios::binary | std::ios::in);
+  SlotMapHeader header{};
+  map_io.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!map_io || header.magic_ != SLOT_MAP_MAGIC) {
+    throw Exception("can't read the slot map of the compressed db file");
+  }
+  std::vector<SlotMapEntry> entries(header.num_slots_);
+  map_io.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(SlotMapEntry));
+  if (!map_io) {
+    throw Exception("can't read the slot map of the compressed db file");
+  }
+
+  // 槽位之间的空隙就是空闲区间
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.offset_ < b.offset_; });
+  size_t num_file_pages = 0;
+  for (const auto &entry : entries) {
+    if (entry.offset_ > file_end_) {
+      free_extents_[file_end_] = entry.offset_ - file_end_;
+      free_extents_by_size_.emplace(entry.offset_ - file_end_, file_end_);
+    }
+    slots_[entry.page_id_] = {entry.offset_, entry.size_, entry.capacity_};
+    stored_bytes_ += entry.size_;
+    file_end_ = std::max(file_end_, entry.offset_ + entry.capacity_);
+    num_file_pages = std::max(num_file_pages, static_cast<size_t>(entry.page_id_) + 1);
+  }
+  LoadFreeSpaceMap(num_file_pages);
+}
+
+void DiskManagerCompressed::SaveSlotMap() {
+  if (map_name_.empty()) {
+    return;
+  }
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  if (!map_dirty_) {
+    return;
+  }
+  std::vector<SlotMapEntry> entries;
+  entries.reserve(slots_.size());
+  for (const auto &[page_id, slot] : slots_) {
+    entries.push_back({page_id, slot.size_, slot.capacity_, 0, slot.offset_});
+  }
+  // 和空闲页表一样先写临时文件再改名
+  std::string tmp_name = map_name_ + ".tmp";
+  std::ofstream map_io(tmp_name, std::ios::binary | std::ios::trunc | std::ios::out);
+  SlotMapHeader header{SLOT_MAP_MAGIC, entries.size()};
+  map_io.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  map_io.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(SlotMapEntry));
+  map_io.close();
+  if (map_io.fail() || std::rename(tmp_name.c_str(), map_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing slot map");
+    return;
+  }
+  map_dirty_ = false;
+}
+
+}  // namespace bustub
@@ -39,6 +39,15 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Write the contents of consecutive pages into disk file
+ */
+void DiskManagerMemory::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  size_t offset = static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += num_pages;
+  memcpy(memory_ + offset, pages_data, num_pages * BUSTUB_PAGE_SIZE);
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) {
+  file_name_ = db_file;
+  fd_ = open(db_file.c_str(), O_RDONLY);  // NOLINT
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat st {};
+  if (fstat(fd_, &st) != 0) {
+    close(fd_);
+    throw Exception("can't stat db file");
+  }
+  size_ = st.st_size;
+  if (size_ == 0) {
+    // mmap 不接受长度为 0 的映射, 空文件的每一页都读作全零
+    return;
+  }
+  void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    close(fd_);
+    throw Exception("can't mmap db file");
+  }
+  data_ = static_cast<char *>(data);
+}
+
+DiskManagerMmap::~DiskManagerMmap() { Unmap(); }
+
+void DiskManagerMmap::ShutDown() {
+  Unmap();
+  DiskManager::ShutDown();
+}
+
+void DiskManagerMmap::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+  }
+  size_ = 0;
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception("DiskManagerMmap is read-only, can't write page " + std::to_string(page_id));
+}
+
+void DiskManagerMmap::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  throw Exception("DiskManagerMmap is read-only, can't write page " + std::to_string(first_page_id));
+}
+
+auto DiskManagerMmap::GetPagePointer(page_id_t page_id) const -> const char * {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (data_ == nullptr || offset + BUSTUB_PAGE_SIZE > size_) {
+    return nullptr;
+  }
+  return data_ + offset;
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  const char *page = GetPagePointer(page_id);
+  if (page != nullptr) {
+    memcpy(page_data, page, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  LOG_DEBUG("I/O error reading past end of file");
+  // 快照末尾的不完整页, 有效部分照常拷贝
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t valid = data_ != nullptr && offset < size_ ? size_ - offset : 0;
+  if (valid > 0) {
+    memcpy(page_data, data_ + offset, valid);
+  }
+  memset(page_data + valid, 0, BUSTUB_PAGE_SIZE - valid);
+}
+
+}  // namespace bustub
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.cpp
+//
+// Identification: src/storage/disk/disk_manager_posix.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_posix.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+struct FreeDeleter {
+  void operator()(char *p) const { std::free(p); }  // NOLINT
+};
+
+auto AllocAligned(size_t size) -> std::unique_ptr<char, FreeDeleter> {
+  return std::unique_ptr<char, FreeDeleter>(
+      static_cast<char *>(std::aligned_alloc(DiskManagerPosix::DIRECT_IO_ALIGNMENT, size)));
+}
+
+auto IsAligned(const char *p) -> bool {
+  return reinterpret_cast<uintptr_t>(p) % DiskManagerPosix::DIRECT_IO_ALIGNMENT == 0;
+}
+
+}  // namespace
+
+/**
+ * The base constructor creates the db file and the log file; the db stream is then replaced by a raw descriptor.
+ */
+DiskManagerPosix::DiskManagerPosix(const std::string &db_file, bool direct_io) : DiskManager(db_file) {
+  db_io_.close();
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);  // NOLINT
+    if (fd_ >= 0) {
+      direct_io_ = true;
+    } else {
+      // e.g. tmpfs does not support O_DIRECT
+      LOG_WARN("O_DIRECT not supported for %s, falling back to buffered I/O", db_file.c_str());
+    }
+  }
+#endif
+  if (fd_ < 0) {
+    fd_ = open(db_file.c_str(), flags, 0644);  // NOLINT
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat st {};
+  if (fstat(fd_, &st) == 0) {
+    file_size_ = st.st_size;
+  }
+}
+
+DiskManagerPosix::~DiskManagerPosix() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void DiskManagerPosix::ShutDown() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  DiskManager::ShutDown();
+}
+
+void DiskManagerPosix::WriteAt(size_t offset, const char *data, size_t size) {
+  std::unique_ptr<char, FreeDeleter> bounce;
+  if (direct_io_ && !IsAligned(data)) {
+    bounce = AllocAligned(size);
+    memcpy(bounce.get(), data, size);
+    data = bounce.get();
+  }
+  size_t written = 0;
+  while (written < size) {
+    ssize_t ret = pwrite(fd_, data + written, size - written, offset + written);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing: %s", strerror(errno));
+      return;
+    }
+    written += ret;
+  }
+  GrowFileSize(offset + size);
+}
+
+void DiskManagerPosix::GrowFileSize(size_t end) {
+  // 只会增大, 并发写入时用 CAS 取最大值
+  size_t cur = file_size_.load();
+  while (cur < end && !file_size_.compare_exchange_weak(cur, end)) {
+  }
+}
+
+void DiskManagerPosix::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  WriteAt(static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE, page_data, BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerPosix::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  num_writes_ += num_pages;
+  WriteAt(static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE, pages_data, num_pages * BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * Read the contents of the specified page into the given memory area. Pages past the end of the file read as zeros.
+ */
+void DiskManagerPosix::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (offset >= file_size_.load()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  std::unique_ptr<char, FreeDeleter> bounce;
+  char *buf = page_data;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce = AllocAligned(BUSTUB_PAGE_SIZE);
+    buf = bounce.get();
+  }
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t ret = pread(fd_, buf + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      LOG_DEBUG("I/O error while reading: %s", strerror(errno));
+      break;
+    }
+    if (ret == 0) {
+      LOG_DEBUG("Read less than a page");
+      break;
+    }
+    read_count += ret;
+  }
+  memset(buf + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  if (buf != page_data) {
+    memcpy(page_data, buf, BUSTUB_PAGE_SIZE);
+  }
+}
+
+void DiskManagerPosix::Sync() {
+  if (fd_ >= 0 && fdatasync(fd_) != 0) {
+    LOG_DEBUG("fdatasync failed: %s", strerror(errno));
+  }
+  DiskManager::Sync();
+}
+
+}  // namespace bustub
@@ -0,0 +1,284 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+// liburing is not required: the ring is driven through the raw system calls.
+auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, bool direct_io, bool use_io_uring,
+                                   size_t queue_depth)
+    : DiskManagerPosix(db_file, direct_io), queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  if (use_io_uring && SetUpRing()) {
+    return;
+  }
+  if (use_io_uring) {
+    LOG_WARN("io_uring is not available, falling back to a pread/pwrite thread pool");
+  }
+  pool_.reserve(FALLBACK_NUM_THREADS);
+  for (size_t i = 0; i < FALLBACK_NUM_THREADS; i++) {
+    pool_.emplace_back([this] { StartPoolThread(); });
+  }
+}
+
+DiskManagerUring::~DiskManagerUring() {
+  for (size_t i = 0; i < pool_.size(); i++) {
+    pool_queue_.Put(std::nullopt);
+  }
+  for (auto &thread : pool_) {
+    thread.join();
+  }
+  TearDownRing();
+}
+
+void DiskManagerUring::ShutDown() {
+  {
+    std::scoped_lock lk(ring_latch_);
+    TearDownRing();
+  }
+  DiskManagerPosix::ShutDown();
+}
+
+auto DiskManagerUring::SetUpRing() -> bool {
+  io_uring_params params{};
+  int ring_fd = IoUringSetup(queue_depth_, &params);
+  if (ring_fd < 0) {
+    return false;
+  }
+  ring_fd_ = ring_fd;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                 IORING_OFF_SQ_RING);
+  if (sq_ptr_ == MAP_FAILED) {
+    sq_ptr_ = nullptr;
+    TearDownRing();
+    return false;
+  }
+  if (single_mmap) {
+    cq_ptr_ = sq_ptr_;
+  } else {
+    cq_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                   IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      cq_ptr_ = nullptr;
+      TearDownRing();
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    TearDownRing();
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ptr_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+  auto *cq = static_cast<char *>(cq_ptr_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+void DiskManagerUring::TearDownRing() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_ring_size_);
+  }
+  cq_ptr_ = nullptr;
+  if (sq_ptr_ != nullptr) {
+    munmap(sq_ptr_, sq_ring_size_);
+    sq_ptr_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+void DiskManagerUring::ExecuteBatch(const std::vector<DiskIO> &ios,
+                                    const std::function<void(size_t, std::exception_ptr)> &on_complete) {
+  if (ios.size() == 1) {
+    ExecuteSync(ios[0], 0, on_complete);
+  } else if (UsesIoUring()) {
+    ExecuteBatchRing(ios, on_complete);
+  } else {
+    ExecuteBatchPool(ios, on_complete);
+  }
+}
+
+void DiskManagerUring::ExecuteSync(const DiskIO &io, size_t idx,
+                                   const std::function<void(size_t, std::exception_ptr)> &on_complete) {
+  try {
+    if (io.is_write_) {
+      WritePages(io.page_id_, io.data_, io.num_pages_);
+    } else {
+      ReadPage(io.page_id_, io.data_);
+    }
+    on_complete(idx, nullptr);
+  } catch (...) {
+    on_complete(idx, std::current_exception());
+  }
+}
+
+void DiskManagerUring::ExecuteBatchRing(const std::vector<DiskIO> &ios,
+                                        const std::function<void(size_t, std::exception_ptr)> &on_complete) {
+  std::vector<iovec> iovs(ios.size());
+  std::scoped_lock lk(ring_latch_);
+  size_t next = 0;
+  // pending: 已放入 SQ 但内核还没取走; inflight: 已提交但还没完成
+  unsigned pending = 0;
+  size_t inflight = 0;
+  while (true) {
+    unsigned tail = *sq_tail_;
+    while (next < ios.size() && inflight + pending < sq_entries_) {
+      size_t i = next++;
+      const DiskIO &io = ios[i];
+      size_t offset = static_cast<size_t>(io.page_id_) * BUSTUB_PAGE_SIZE;
+      if (!io.is_write_ && offset >= file_size_.load()) {
+        memset(io.data_, 0, BUSTUB_PAGE_SIZE);
+        on_complete(i, nullptr);
+        continue;
+      }
+      if (direct_io_ && reinterpret_cast<uintptr_t>(io.data_) % DIRECT_IO_ALIGNMENT != 0) {
+        // 需要对齐的中转缓冲区, 走同步路径
+        ExecuteSync(io, i, on_complete);
+        continue;
+      }
+      iovs[i].iov_base = io.data_;
+      iovs[i].iov_len = io.num_pages_ * BUSTUB_PAGE_SIZE;
+      unsigned idx = tail & *sq_mask_;
+      io_uring_sqe *sqe = &sqes_[idx];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = io.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->off = offset;
+      sqe->addr = reinterpret_cast<uint64_t>(&iovs[i]);
+      sqe->len = 1;
+      sqe->user_data = i;
+      sq_array_[idx] = idx;
+      tail++;
+      pending++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    if (pending == 0 && inflight == 0) {
+      return;
+    }
+
+    int ret = IoUringEnter(ring_fd_, pending, 1, IORING_ENTER_GETEVENTS);
+    if (ret >= 0) {
+      pending -= ret;
+      inflight += ret;
+    } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      throw Exception(std::string("io_uring_enter failed: ") + strerror(errno));
+    }
+
+    unsigned head = *cq_head_;
+    unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != cq_tail; head++) {
+      const io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+      size_t i = cqe->user_data;
+      int res = cqe->res;
+      inflight--;
+      const DiskIO &io = ios[i];
+      size_t offset = static_cast<size_t>(io.page_id_) * BUSTUB_PAGE_SIZE;
+      size_t len = io.num_pages_ * BUSTUB_PAGE_SIZE;
+      if (res < 0) {
+        LOG_DEBUG("io_uring I/O error: %s, retrying synchronously", strerror(-res));
+        ExecuteSync(io, i, on_complete);
+        continue;
+      }
+      auto done = static_cast<size_t>(res);
+      if (io.is_write_) {
+        if (done < len) {
+          WriteAt(offset + done, io.data_ + done, len - done);
+        } else {
+          GrowFileSize(offset + len);
+        }
+        num_writes_ += io.num_pages_;
+      } else if (done < len) {
+        // 读到文件末尾
+        memset(io.data_ + done, 0, len - done);
+      }
+      on_complete(i, nullptr);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+}
+
+void DiskManagerUring::ExecuteBatchPool(const std::vector<DiskIO> &ios,
+                                        const std::function<void(size_t, std::exception_ptr)> &on_complete) {
+  std::mutex latch;
+  std::condition_variable cv;
+  size_t remaining = ios.size();
+  for (size_t i = 0; i < ios.size(); i++) {
+    pool_queue_.Put(std::function<void()>([&, i] {
+      ExecuteSync(ios[i], i, on_complete);
+      std::scoped_lock lk(latch);
+      if (--remaining == 0) {
+        cv.notify_one();
+      }
+    }));
+  }
+  std::unique_lock lk(latch);
+  cv.wait(lk, [&] { return remaining == 0; });
+}
+
+void DiskManagerUring::StartPoolThread() {
+  while (true) {
+    auto task = pool_queue_.Get();
+    if (!task.has_value()) {
+      return;
+    }
+    (*task)();
+  }
+}
+
+}  // namespace bustub
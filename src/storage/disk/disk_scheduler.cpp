@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+  BUSTUB_ENSURE(num_workers > 0, "disk scheduler needs at least one worker");
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back([this] { StartWorkerThread(); });
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  // Put one `std::nullopt` per worker in the queue to signal each of them to exit the loop
+  for (size_t i = 0; i < workers_.size(); i++) {
+    request_queue_.Put(std::nullopt);
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) { request_queue_.Put(std::make_optional(std::move(r))); }
+
+auto DiskScheduler::ScheduleRead(page_id_t page_id, char *data) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule({/*is_write=*/false, data, page_id, std::move(promise)});
+  return future;
+}
+
+auto DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data, size_t num_pages) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  // The disk manager only reads from the buffer on a write.
+  Schedule({/*is_write=*/true, const_cast<char *>(data), page_id, std::move(promise), num_pages});  // NOLINT
+  return future;
+}
+
+void DiskScheduler::StartWorkerThread() {
+  std::vector<DiskRequest> batch;
+  std::vector<DiskIO> ios;
+  size_t max_batch = std::min(disk_manager_->GetMaxBatchSize(), static_cast<size_t>(DISK_SCHEDULER_MAX_BATCH));
+  bool stop = false;
+  while (!stop) {
+    auto request = request_queue_.Get();
+    if (!request.has_value()) {
+      return;
+    }
+    batch.push_back(std::move(*request));
+    // 把已排队的请求一起交给 disk manager, 支持批量 I/O 的实现可以同时在途多个请求
+    while (batch.size() < max_batch) {
+      auto next = request_queue_.TryGet();
+      if (!next.has_value()) {
+        break;
+      }
+      if (!next->has_value()) {
+        // 这个 worker 的退出标记, 处理完当前批次后退出
+        stop = true;
+        break;
+      }
+      batch.push_back(std::move(**next));
+    }
+    for (auto &r : batch) {
+      ios.push_back({r.is_write_, r.page_id_, r.data_, r.num_pages_});
+    }
+    auto start = std::chrono::steady_clock::now();
+    disk_manager_->ExecuteBatch(ios, [this, &batch, start](size_t idx, const std::exception_ptr &error) {
+      (batch[idx].is_write_ ? write_latency_ : read_latency_).RecordSince(start);
+      if (error == nullptr) {
+        batch[idx].callback_.set_value(true);
+      } else {
+        batch[idx].callback_.set_exception(error);
+      }
+    });
+    batch.clear();
+    ios.clear();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/storage/disk/page_codec.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t HASH_BITS = 12;
+constexpr size_t MAX_LENGTH_NIBBLE = 15;
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+auto Hash(uint32_t v) -> size_t { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Writes sequences into a bounded output buffer. ok_ turns false once the output does not fit. */
+class SequenceWriter {
+ public:
+  SequenceWriter(char *dst, size_t capacity) : dst_(dst), capacity_(capacity) {}
+
+  /** Write a sequence. match_length 0 means the last sequence, which has no match. */
+  void Write(const char *literals, size_t literal_length, size_t offset, size_t match_length) {
+    size_t match_nibble = match_length == 0 ? 0 : match_length - PageCodec::MIN_MATCH;
+    Put(static_cast<char>((std::min(literal_length, MAX_LENGTH_NIBBLE) << 4) |
+                          std::min(match_nibble, MAX_LENGTH_NIBBLE)));
+    PutLength(literal_length);
+    if (!ok_ || size_ + literal_length > capacity_) {
+      ok_ = false;
+      return;
+    }
+    memcpy(dst_ + size_, literals, literal_length);
+    size_ += literal_length;
+    if (match_length == 0) {
+      return;
+    }
+    Put(static_cast<char>(offset & 0xFF));
+    Put(static_cast<char>(offset >> 8));
+    PutLength(match_nibble);
+  }
+
+  auto Ok() const -> bool { return ok_; }
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  void Put(char c) {
+    if (size_ >= capacity_) {
+      ok_ = false;
+      return;
+    }
+    dst_[size_++] = c;
+  }
+
+  /** Write the part of a length that does not fit into its nibble. */
+  void PutLength(size_t length) {
+    if (length < MAX_LENGTH_NIBBLE) {
+      return;
+    }
+    length -= MAX_LENGTH_NIBBLE;
+    while (length >= 255) {
+      Put(static_cast<char>(255));
+      length -= 255;
+    }
+    Put(static_cast<char>(length));
+  }
+
+  char *dst_;
+  size_t capacity_;
+  size_t size_{0};
+  bool ok_{true};
+};
+
+/** Read the part of a length that did not fit into its nibble. @return false if src ends first */
+auto GetLength(const unsigned char *src, size_t src_size, size_t *pos, size_t *length) -> bool {
+  if (*length < MAX_LENGTH_NIBBLE) {
+    return true;
+  }
+  unsigned char b;
+  do {
+    if (*pos >= src_size) {
+      return false;
+    }
+    b = src[(*pos)++];
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+}  // namespace
+
+auto PageCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  // 记录每个4字节序列(按哈希)最后出现的位置, 冲突时直接覆盖
+  std::array<int64_t, static_cast<size_t>(1) << HASH_BITS> last_seen;
+  last_seen.fill(-1);
+  SequenceWriter writer(dst, capacity);
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size && writer.Ok()) {
+    uint32_t v = Load32(src + pos);
+    size_t h = Hash(v);
+    int64_t candidate = last_seen[h];
+    last_seen[h] = static_cast<int64_t>(pos);
+    if (candidate < 0 || pos - candidate > MAX_OFFSET || Load32(src + candidate) != v) {
+      ++pos;
+      continue;
+    }
+    size_t length = MIN_MATCH;
+    while (pos + length < size && src[candidate + length] == src[pos + length]) {
+      ++length;
+    }
+    writer.Write(src + anchor, pos - anchor, pos - candidate, length);
+    pos += length;
+    anchor = pos;
+  }
+  writer.Write(src + anchor, size - anchor, 0, 0);
+  return writer.Ok() ? writer.Size() : 0;
+}
+
+auto PageCodec::Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool {
+  const auto *in = reinterpret_cast<const unsigned char *>(src);
+  size_t pos = 0;
+  size_t out = 0;
+  while (pos < src_size) {
+    unsigned char token = in[pos++];
+    size_t literal_length = token >> 4;
+    if (!GetLength(in, src_size, &pos, &literal_length) || pos + literal_length > src_size ||
+        out + literal_length > size) {
+      return false;
+    }
+    memcpy(dst + out, src + pos, literal_length);
+    pos += literal_length;
+    out += literal_length;
+    if (pos == src_size) {
+      break;
+    }
+    if (pos + 2 > src_size) {
+      return false;
+    }
+    size_t offset = in[pos] | (static_cast<size_t>(in[pos + 1]) << 8);
+    pos += 2;
+    size_t match_length = token & MAX_LENGTH_NIBBLE;
+    if (!GetLength(in, src_size, &pos, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > out || out + match_length > size) {
+      return false;
+    }
+    // 匹配可能和自身的输出重叠(比如连续的0), 只能逐字节复制
+    for (size_t i = 0; i < match_length; ++i, ++out) {
+      dst[out] = dst[out - offset];
+    }
+  }
+  return out == size;
+}
+
+}  // namespace bustub
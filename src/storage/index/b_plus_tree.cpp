@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <deque>
 #include <fstream>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -19,13 +24,14 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size, bool swizzle)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      header_page_id_(header_page_id),
+      swizzle_(swizzle) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
@@ -49,48 +55,216 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;
-  auto header_guard = bpm_->FetchPageRead(header_page_id_);
-  page_id_t page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
-  if (page_id == INVALID_PAGE_ID) {
+  auto leaf_guard = FindLeafOptimistic(key);
+  if (!leaf_guard.has_value()) {
     return false;
   }
-  ctx.read_set_.push_back(bpm_->FetchPageRead(page_id));
-  const auto *page = ctx.read_set_.back().As<BPlusTreePage>();
-  while (!page->IsLeafPage()) {
-    // 不是叶子 继续向下找
-    const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
-    bool found = false;
-    for (int i = 1; i < internal_page->GetSize(); ++i) {
-      if (comparator_(key, internal_page->KeyAt(i)) < 0) {
-        // 找到了
-        found = true;
-        page_id = internal_page->ValueAt(i - 1);
-        ctx.read_set_.push_back(bpm_->FetchPageRead(page_id));
-        page = ctx.read_set_.back().As<BPlusTreePage>();
-        ctx.read_set_.pop_front();
-        break;
-      }
+  // 找到了叶子节点，开始找key
+  const auto *p = leaf_guard->template As<LeafPage>();
+  int pos = p->KeyIndex(key, comparator_);
+  if (pos < p->GetSize() && comparator_(key, p->KeyAt(pos)) == 0) {
+    result->push_back(p->ValueAt(pos));
+    return true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key) -> std::optional<ReadPageGuard> {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_RESTARTS; ++attempt) {
+    OptimisticReadGuard node;
+    if (!DescendOptimistic(key, &node)) {
+      continue;
+    }
+    if (node.GetData() == nullptr) {
+      return std::nullopt;
     }
-    if (!found) {
-      // 如果前面没找到，就是在最后一个value里
-      found = true;
-      page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
-      ctx.read_set_.push_back(bpm_->FetchPageRead(page_id));
-      page = ctx.read_set_.back().As<BPlusTreePage>();
-      ctx.read_set_.pop_front();
+    // 只有叶子加读锁, 加锁后版本号没变就说明它还是这个叶子
+    auto leaf_guard = bpm_->FetchPageRead(node.PageId());
+    if (node.Validate()) {
+      return leaf_guard;
     }
   }
-  // 找到了叶子节点，开始找key
-  const auto *p = reinterpret_cast<const LeafPage *>(page);
-  for (int i = 0; i < p->GetSize(); i++) {
-    if (comparator_(key, p->KeyAt(i)) == 0) {
-      result->push_back(p->ValueAt(i));
+  return FindLeafRead(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafWriteOptimistic(const KeyType &key, bool insert) -> std::optional<WritePageGuard> {
+  // 叶子最多只放一个kv时, 插入必然分裂, 删除必然下溢, 乐观下降只是白走一趟
+  if (leaf_max_size_ <= 2) {
+    return std::nullopt;
+  }
+  // 只试一次: 验证失败说明路径上有别的写者或者页面被换出了, 直接走悲观路径比重新下降更划算
+  OptimisticReadGuard node;
+  if (!DescendOptimistic(key, &node) || node.GetData() == nullptr) {
+    return std::nullopt;
+  }
+  // 先不加锁看一眼叶子的大小, 反正要分裂或下溢的话就不用加锁了
+  alignas(std::max_align_t) char copy[sizeof(BPlusTreePage)];
+  memcpy(copy, node.GetData(), sizeof(copy));
+  if (!node.Validate()) {
+    return std::nullopt;
+  }
+  const auto *leaf = reinterpret_cast<const BPlusTreePage *>(copy);
+  if (insert ? leaf->GetSize() >= leaf->GetRealMax() : leaf->GetSize() <= leaf->GetMinSize()) {
+    return std::nullopt;
+  }
+  // 加写锁本身会让版本号加一, 除此之外没变才说明它还是这个叶子
+  auto leaf_guard = bpm_->FetchPageWrite(node.PageId());
+  if (!node.ValidateWriteLatched()) {
+    return std::nullopt;
+  }
+  return leaf_guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendOptimistic(const KeyType &key, OptimisticReadGuard *leaf) -> bool {
+  // 内部节点先拷贝出来, 验证版本号之后才在拷贝上比较key, 不会用到读了一半的数据
+  alignas(std::max_align_t) char copy[BUSTUB_PAGE_SIZE];
+  const auto *internal_page = reinterpret_cast<const InternalPage *>(copy);
+  constexpr int max_entries = (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(page_id_t));
+  auto parent = bpm_->FetchPageOptimistic(header_page_id_);
+  if (parent.GetData() == nullptr) {
+    return false;
+  }
+  page_id_t page_id = parent.template As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!parent.Validate()) {
+    return false;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    *leaf = OptimisticReadGuard();
+    return true;
+  }
+  int slot = 0;
+  bool right = false;
+  while (true) {
+    // 沿右链接过去的页面不是父节点的孩子, 没有swip
+    auto node = right ? bpm_->FetchPageOptimistic(page_id) : FetchChildOptimistic(parent, slot, page_id);
+    // 拿到孩子的版本号之后父节点仍然没变, page_id才确实是要找的孩子
+    if (node.GetData() == nullptr || !parent.Validate()) {
+      return false;
+    }
+    memcpy(copy, node.GetData(), INTERNAL_PAGE_HEADER_SIZE + sizeof(KeyType));
+    if (IsBeyond(internal_page, key)) {
+      // 节点在父节点被读到之后分裂了, key在右边
+      if (!node.Validate()) {
+        return false;
+      }
+      page_id = internal_page->GetNextPageId();
+      parent = node;
+      right = true;
+      continue;
+    }
+    if (internal_page->IsLeafPage()) {
+      *leaf = node;
       return true;
     }
+    int size = std::clamp(internal_page->GetSize(), 1, max_entries);
+    InternalPage::CopyEntries(copy, node.GetData(), size);
+    if (!node.Validate()) {
+      return false;
+    }
+    slot = internal_page->Lookup(key, comparator_);
+    page_id = internal_page->ValueAt(slot);
+    parent = node;
+    right = false;
   }
-  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType &key) -> std::optional<ReadPageGuard> {
+  // 往右走的时候拿着左边等右边的锁, 和合并的加锁顺序相反. 所以第一次遇到没插完分隔key的分裂就放开重来,
+  // 拿着结构锁再走, 这时不会有合并
+  std::shared_lock<std::shared_mutex> structure(structure_latch_, std::defer_lock);
+  while (true) {
+    auto header_guard = bpm_->FetchPageRead(header_page_id_);
+    page_id_t page_id = header_guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    // 读锁螺旋下降: 拿到孩子(或者右兄弟)之后才放开当前节点
+    ReadPageGuard page_guard = FetchChildRead(header_guard, 0, page_id);
+    header_guard.Drop();
+    while (true) {
+      const auto *page = page_guard.template As<BPlusTreePage>();
+      if (IsBeyond(page, key)) {
+        if (!structure.owns_lock()) {
+          break;
+        }
+        page_guard = bpm_->FetchPageRead(page->GetNextPageId());
+        continue;
+      }
+      if (page->IsLeafPage()) {
+        return page_guard;
+      }
+      const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
+      int slot = internal_page->Lookup(key, comparator_);
+      page_guard = FetchChildRead(page_guard, slot, internal_page->ValueAt(slot));
+    }
+    page_guard.Drop();
+    structure.lock();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafWrite(const KeyType &key, std::vector<page_id_t> *path) -> std::optional<WritePageGuard> {
+  auto header_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = header_guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+  ReadPageGuard page_guard = FetchChildRead(header_guard, 0, page_id);
+  header_guard.Drop();
+  while (true) {
+    const auto *page = page_guard.template As<BPlusTreePage>();
+    if (IsBeyond(page, key)) {
+      page_guard = bpm_->FetchPageRead(page->GetNextPageId());
+      continue;
+    }
+    if (page->IsLeafPage()) {
+      break;
+    }
+    path->push_back(page_guard.PageId());
+    const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
+    int slot = internal_page->Lookup(key, comparator_);
+    page_guard = FetchChildRead(page_guard, slot, internal_page->ValueAt(slot));
+  }
+  // 读锁换成写锁. 中间叶子可能分裂了, 再往右找; 持有结构锁的时候叶子不会被合并掉
+  page_id = page_guard.PageId();
+  page_guard.Drop();
+  WritePageGuard leaf_guard = bpm_->FetchPageWrite(page_id);
+  while (IsBeyond(leaf_guard.template As<BPlusTreePage>(), key)) {
+    leaf_guard = bpm_->FetchPageWrite(leaf_guard.template As<BPlusTreePage>()->GetNextPageId());
+  }
+  return leaf_guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindPageOnLevel(const KeyType &key, int level) -> page_id_t {
+  auto header_guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard page_guard = FetchChildRead(header_guard, 0, header_guard.As<BPlusTreeHeaderPage>()->root_page_id_);
+  header_guard.Drop();
+  while (true) {
+    const auto *page = page_guard.template As<BPlusTreePage>();
+    BUSTUB_ASSERT(page->GetLevel() >= level, "the tree never gets lower while a split is posted");
+    if (IsBeyond(page, key)) {
+      page_guard = bpm_->FetchPageRead(page->GetNextPageId());
+      continue;
+    }
+    if (page->GetLevel() == level) {
+      return page_guard.PageId();
+    }
+    const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
+    int slot = internal_page->Lookup(key, comparator_);
+    page_guard = FetchChildRead(page_guard, slot, internal_page->ValueAt(slot));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsBeyond(const BPlusTreePage *page, const KeyType &key) const -> bool {
+  // 叶子和内部节点的high key在同一个位置
+  const auto *node = reinterpret_cast<const InternalPage *>(page);
+  return node->GetNextPageId() != INVALID_PAGE_ID && comparator_(key, node->GetHighKey()) >= 0;
 }
 
 /*****************************************************************************
@@ -111,154 +285,152 @@ void ReleaseLock(Context &ctx) {
   }
   ctx.write_set_.push_back(std::move(temp));
 }
+
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertParent(Context &ctx, page_id_t old_value, page_id_t new_value, const KeyType &key) {
-  if (old_value == ctx.root_page_id_) {
-    // 也就是已经回溯到跟节点了
+void BPLUSTREE_TYPE::InsertParent(std::vector<page_id_t> *path, page_id_t left_id, int level, const KeyType &key,
+                                  page_id_t right_id) {
+  // 每往上一层, 要插的分隔key就换成这一层分裂出来的那个
+  KeyType separator = key;
+  while (true) {
+    page_id_t parent_id;
+    if (path->empty()) {
+      auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+      auto *header = header_guard.AsMut<BPlusTreeHeaderPage>();
+      if (header->root_page_id_ == left_id) {
+        // 也就是已经回溯到根节点了, 长出新根
+        page_id_t new_id;
+        auto new_guard = bpm_->NewWriteGuarded(&new_id);
+        auto *new_page = new_guard.AsMut<InternalPage>();
+        new_page->SetPageType(IndexPageType::INTERNAL_PAGE);
+        new_page->SetMaxSize(internal_max_size_);
+        new_page->SetLevel(level + 1);
+        new_page->SetNextPageId(INVALID_PAGE_ID);
+        new_page->SetSize(2);
+        new_page->SetValueAt(0, left_id);
+        new_page->SetKeyAt(1, separator);
+        new_page->SetValueAt(1, right_id);
+        header->root_page_id_ = new_id;
+        return;
+      }
+      // 下降之后根被别的插入分裂过了, 父节点在下降时没经过的那一层上
+      header_guard.Drop();
+      parent_id = FindPageOnLevel(separator, level + 1);
+    } else {
+      parent_id = path->back();
+      path->pop_back();
+    }
+    // 下降之后父节点可能也分裂了, 往右找到管着key的那个
+    auto parent_guard = bpm_->FetchPageWrite(parent_id);
+    while (IsBeyond(parent_guard.As<BPlusTreePage>(), separator)) {
+      parent_guard = bpm_->FetchPageWrite(parent_guard.As<BPlusTreePage>()->GetNextPageId());
+    }
+    auto *parent_page = parent_guard.AsMut<InternalPage>();
+    // 新的kv一定紧挨在左半边的右边
+    int pos = parent_page->Lookup(separator, comparator_) + 1;
+    BUSTUB_ASSERT(parent_page->ValueAt(pos - 1) == left_id, "the left half of a split is where its separator goes");
+    if (parent_page->GetSize() < parent_page->GetRealMax()) {
+      // 可以直接插入
+      for (int i = parent_page->GetSize() - 1; i >= pos; i--) {
+        parent_page->SetKeyAt(i + 1, parent_page->KeyAt(i));
+        parent_page->SetValueAt(i + 1, parent_page->ValueAt(i));
+      }
+      parent_page->SetKeyAt(pos, separator);
+      parent_page->SetValueAt(pos, right_id);
+      parent_page->IncreaseSize(1);
+      return;
+    }
+    //  需要分裂
+    std::deque<std::pair<KeyType, page_id_t>> temp;
+    for (int i = 0; i < pos; i++) {
+      temp.push_back({parent_page->KeyAt(i), parent_page->ValueAt(i)});
+    }
+    temp.push_back({separator, right_id});
+    for (int i = pos; i < parent_page->GetSize(); ++i) {
+      temp.push_back({parent_page->KeyAt(i), parent_page->ValueAt(i)});
+    }
+    // 给parent_page min_size 个
+    for (int i = 0; i < parent_page->GetMinSize(); ++i) {
+      parent_page->SetKeyAt(i, temp.front().first);
+      parent_page->SetValueAt(i, temp.front().second);
+      temp.pop_front();
+    }
+    parent_page->SetSize(parent_page->GetMinSize());
+    // 新建页面装入剩下的kv
     page_id_t new_id;
     auto new_guard = bpm_->NewWriteGuarded(&new_id);
     auto *new_page = new_guard.AsMut<InternalPage>();
     new_page->SetPageType(IndexPageType::INTERNAL_PAGE);
     new_page->SetMaxSize(internal_max_size_);
-    new_page->SetSize(2);
-    new_page->SetValueAt(0, old_value);
-    new_page->SetKeyAt(1, key);
-    new_page->SetValueAt(1, new_value);
-    if (ctx.header_page_.has_value()) {
-      ctx.header_page_.value().AsMut<BPlusTreeHeaderPage>()->root_page_id_ = new_id;
-    }
-    return;
-  }
-  page_id_t parent_id = ctx.write_set_.back().PageId();
-  (void)parent_id;
-  auto *parent_page = ctx.write_set_.back().AsMut<InternalPage>();
-  // 找到key该放的位置
-  int pos;
-  for (pos = 0; pos < parent_page->GetSize(); pos++) {
-    if (parent_page->ValueAt(pos) == old_value) {
-      // 新的kv一定在老的右边，因此找到老的就确定了新的位置
-      pos += 1;
-      break;
-    }
-  }
-  if (parent_page->GetSize() < parent_page->GetRealMax()) {
-    // 可以直接插入
-    for (int i = parent_page->GetSize(); i >= pos; i--) {
-      parent_page->SetKeyAt(i + 1, parent_page->KeyAt(i));
-      parent_page->SetValueAt(i + 1, parent_page->ValueAt(i));
+    new_page->SetLevel(parent_page->GetLevel());
+    int i = 0;
+    while (!temp.empty()) {
+      new_page->SetKeyAt(i, temp.front().first);
+      new_page->SetValueAt(i, temp.front().second);
+      i++;
+      temp.pop_front();
     }
-    parent_page->SetKeyAt(pos, key);
-    parent_page->SetValueAt(pos, new_value);
-    parent_page->IncreaseSize(1);
-    return;
-  }
-  //  需要分裂
-  std::deque<std::pair<KeyType, page_id_t>> temp;
-  for (int i = 0; i < pos; i++) {
-    temp.push_back({parent_page->KeyAt(i), parent_page->ValueAt(i)});
-  }
-  temp.push_back({key, new_value});
-  for (int i = pos; i < parent_page->GetSize(); ++i) {
-    temp.push_back({parent_page->KeyAt(i), parent_page->ValueAt(i)});
-  }
-  // 给parent_page min_size 个
-  for (int i = 0; i < parent_page->GetMinSize(); ++i) {
-    parent_page->SetKeyAt(i, temp.front().first);
-    parent_page->SetValueAt(i, temp.front().second);
-    temp.pop_front();
+    new_page->SetSize(i);
+    // 先在这一层把两半连起来, 放开之后再去上一层插分隔key
+    new_page->SetNextPageId(parent_page->GetNextPageId());
+    new_page->SetHighKey(parent_page->GetHighKey());
+    parent_page->SetNextPageId(new_id);
+    parent_page->SetHighKey(new_page->KeyAt(0));
+    left_id = parent_guard.PageId();
+    right_id = new_id;
+    level = parent_page->GetLevel();
+    // key引用的可能是调用者的数据, 换成本地的拷贝
+    separator = new_page->KeyAt(0);
   }
-  parent_page->SetSize(parent_page->GetMinSize());
-  // 新建页面装入剩下的kv
-  page_id_t new_id;
-  auto new_guard = bpm_->NewWriteGuarded(&new_id);
-  auto *new_page = new_guard.AsMut<InternalPage>();
-  new_page->SetPageType(IndexPageType::INTERNAL_PAGE);
-  new_page->SetMaxSize(internal_max_size_);
-  int i = 0;
-  while (!temp.empty()) {
-    new_page->SetKeyAt(i, temp.front().first);
-    new_page->SetValueAt(i, temp.front().second);
-    i++;
-    temp.pop_front();
-  }
-  new_page->SetSize(i);
-  ctx.write_set_.pop_back();
-  InsertParent(ctx, parent_id, new_id, new_page->KeyAt(0));
 }
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;
-  ctx.header_page_.emplace(bpm_->FetchPageWrite(header_page_id_));
-  ctx.root_page_id_ = ctx.header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
-  if (ctx.root_page_id_ == INVALID_PAGE_ID) {
-    // 树空
-    page_id_t root_id;
-    auto root_guard = bpm_->NewWriteGuarded(&root_id);
-    ctx.header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_id;
-    auto *root_page = root_guard.AsMut<LeafPage>();
-    root_page->SetPageType(IndexPageType::LEAF_PAGE);
-    root_page->SetMaxSize(leaf_max_size_);
-    root_page->SetSize(1);
-    root_page->SetKeyAt(0, key);
-    root_page->SetValueAt(0, value);
-    root_page->SetNextPageId(INVALID_PAGE_ID);
-    return true;
-  }
-  // 搜索
-  page_id_t page_id = ctx.root_page_id_;
-  ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
-  auto *page = ctx.write_set_.back().AsMut<BPlusTreePage>();
-  while (!page->IsLeafPage()) {
-    auto *internal_page = reinterpret_cast<InternalPage *>(page);
-    bool found = false;
-    for (int i = 1; i < internal_page->GetSize(); ++i) {
-      if (comparator_(key, internal_page->KeyAt(i)) < 0) {
-        found = true;
-        page_id = internal_page->ValueAt(i - 1);
-        ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
-        page = ctx.write_set_.back().AsMut<BPlusTreePage>();
-        if (page->GetRealMax() > page->GetSize()) {
-          // 释放锁
-          ReleaseLock(ctx);
-        }
-        break;
-      }
+  // 乐观插入: 只给叶子加写锁, 叶子放得下就直接插入, 不碰header和根
+  if (auto leaf_guard = FindLeafWriteOptimistic(key, true); leaf_guard.has_value()) {
+    const auto *leaf = leaf_guard->template As<LeafPage>();
+    int pos = leaf->KeyIndex(key, comparator_);
+    if (pos < leaf->GetSize() && comparator_(key, leaf->KeyAt(pos)) == 0) {
+      return false;
     }
-    if (!found) {
-      found = true;
-      page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
-      ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
-      page = ctx.write_set_.back().AsMut<BPlusTreePage>();
-      if (page->GetRealMax() > page->GetSize()) {
-        // 释放锁
-        ReleaseLock(ctx);
-      }
+    if (leaf->GetSize() < leaf->GetRealMax()) {
+      InsertIntoLeaf(leaf_guard->template AsMut<LeafPage>(), pos, key, value);
+      return true;
     }
+    // 叶子要分裂, 放开叶子重新找
   }
-  // 找到叶子节点
-  auto *leaf_page = reinterpret_cast<LeafPage *>(page);
-  // pos就是新kv的位置
-  int pos;
-  for (pos = 0; pos < leaf_page->GetSize(); pos++) {
-    auto diff = comparator_(key, leaf_page->KeyAt(pos));
-    if (diff == 0) {
-      return false;
-    }
-    if (diff < 0) {
-      break;
+  std::shared_lock<std::shared_mutex> structure(structure_latch_);
+  std::vector<page_id_t> path;
+  auto leaf_guard = FindLeafWrite(key, &path);
+  while (!leaf_guard.has_value()) {
+    // 树空
+    auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+    auto *header = header_guard.AsMut<BPlusTreeHeaderPage>();
+    if (header->root_page_id_ == INVALID_PAGE_ID) {
+      page_id_t root_id;
+      auto root_guard = bpm_->NewWriteGuarded(&root_id);
+      header->root_page_id_ = root_id;
+      auto *root_page = root_guard.AsMut<LeafPage>();
+      root_page->SetPageType(IndexPageType::LEAF_PAGE);
+      root_page->SetMaxSize(leaf_max_size_);
+      root_page->SetLevel(0);
+      root_page->SetSize(1);
+      root_page->SetKeyAt(0, key);
+      root_page->SetValueAt(0, value);
+      root_page->SetNextPageId(INVALID_PAGE_ID);
+      return true;
     }
+    // 别的插入刚刚建好了根
+    header_guard.Drop();
+    leaf_guard = FindLeafWrite(key, &path);
+  }
+  auto *leaf_page = leaf_guard->template AsMut<LeafPage>();
+  // pos就是新kv的位置
+  int pos = leaf_page->KeyIndex(key, comparator_);
+  if (pos < leaf_page->GetSize() && comparator_(key, leaf_page->KeyAt(pos)) == 0) {
+    return false;
   }
   if (leaf_page->GetSize() < leaf_page->GetRealMax()) {
-    // 如果可以直接插入，先将部分元素后移一个
-    for (int i = leaf_page->GetSize() - 1; i >= pos; i--) {
-      leaf_page->SetKeyAt(i + 1, leaf_page->KeyAt(i));
-      leaf_page->SetValueAt(i + 1, leaf_page->ValueAt(i));
-    }
-    leaf_page->SetKeyAt(pos, key);
-    leaf_page->SetValueAt(pos, value);
-    leaf_page->IncreaseSize(1);
-    ctx.write_set_.pop_back();
+    InsertIntoLeaf(leaf_page, pos, key, value);
     return true;
   }
   // 需要分裂
@@ -268,6 +440,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   new_page->SetPageType(IndexPageType::LEAF_PAGE);
   new_page->SetSize(0);
   new_page->SetMaxSize(leaf_max_size_);
+  new_page->SetLevel(0);
   std::deque<std::pair<KeyType, ValueType>> temp;
   // 将leafpage和新加的kv全搬运至temp里
   for (int i = 0; i < pos; i++) {
@@ -292,19 +465,35 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     temp.pop_front();
   }
 
-  // 设置size 和nextpageid
+  // 设置size, 把两半连起来, 左半边的high key就是分隔key
   leaf_page->SetSize(leaf_page->GetMinSize());
   new_page->SetSize(i);
   new_page->SetNextPageId(leaf_page->GetNextPageId());
+  new_page->SetHighKey(leaf_page->GetHighKey());
   leaf_page->SetNextPageId(new_id);
+  leaf_page->SetHighKey(new_page->KeyAt(0));
 
-  // 弹出当前节点的guard
-  ctx.write_set_.pop_back();
-  InsertParent(ctx, page_id, new_id, new_page->KeyAt(0));
-
+  // 两半都放开之后再往父节点插分隔key, 这中间找到左半边的读者会往右走
+  KeyType separator = new_page->KeyAt(0);
+  page_id_t leaf_id = leaf_guard->PageId();
+  leaf_guard = std::nullopt;
+  new_guard.Drop();
+  InsertParent(&path, leaf_id, 0, separator, new_id);
   return true;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoLeaf(LeafPage *leaf_page, int pos, const KeyType &key, const ValueType &value) {
+  // 先将部分元素后移一个
+  for (int i = leaf_page->GetSize() - 1; i >= pos; i--) {
+    leaf_page->SetKeyAt(i + 1, leaf_page->KeyAt(i));
+    leaf_page->SetValueAt(i + 1, leaf_page->ValueAt(i));
+  }
+  leaf_page->SetKeyAt(pos, key);
+  leaf_page->SetValueAt(pos, value);
+  leaf_page->IncreaseSize(1);
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -323,15 +512,8 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
   if (now_page->IsLeafPage()) {
     // 如果节点是叶子
     auto *leaf_page = reinterpret_cast<LeafPage *>(now_page);
-    int pos = 0;
-    bool found = false;
-    for (pos = 0; pos < leaf_page->GetSize(); pos++) {
-      if (comparator_(key, leaf_page->KeyAt(pos)) == 0) {
-        found = true;
-        break;
-      }
-    }
-    if (!found) {
+    int pos = leaf_page->KeyIndex(key, comparator_);
+    if (pos == leaf_page->GetSize() || comparator_(key, leaf_page->KeyAt(pos)) != 0) {
       return;
     }
     // 开始删除
@@ -346,18 +528,14 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
         ctx.header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = INVALID_PAGE_ID;
       }
       ctx.write_set_.pop_back();
+      ctx.deleted_pages_.push_back(now_id);
       return;
     }
 
   } else {
     // 如果非叶子
     auto *internal_page = reinterpret_cast<InternalPage *>(now_page);
-    int pos;
-    for (pos = 1; pos < internal_page->GetSize(); pos++) {
-      if (comparator_(key, internal_page->KeyAt(pos)) < 0) {
-        break;
-      }
-    }
+    int pos = internal_page->Lookup(key, comparator_) + 1;
     // 最后得到的pos是internal_page中比key大的最小的key的位置
     for (int i = pos; i < internal_page->GetSize(); i++) {
       internal_page->SetKeyAt(i - 1, internal_page->KeyAt(i));
@@ -373,6 +551,7 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
       }
       ctx.write_set_.back().Drop();
       ctx.write_set_.pop_back();
+      ctx.deleted_pages_.push_back(now_id);
       return;
     }
   }
@@ -430,6 +609,8 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
           sibling->SetValueAt(sibling->GetSize() + i, now->ValueAt(i));
         }
         sibling->IncreaseSize(now->GetSize());
+        sibling->SetNextPageId(now->GetNextPageId());
+        sibling->SetHighKey(now->GetHighKey());
       } else {
         auto *sibling = reinterpret_cast<LeafPage *>(sibling_page);
         auto *now = reinterpret_cast<LeafPage *>(now_page);
@@ -438,9 +619,11 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
           sibling->SetValueAt(i + sibling->GetSize(), now->ValueAt(i));
         }
         sibling->IncreaseSize(now->GetSize());
-        // 叶子节点要额外设置一下nextpageid
         sibling->SetNextPageId(now->GetNextPageId());
+        sibling->SetHighKey(now->GetHighKey());
       }
+      // 右边的节点被合并进左边, 从树中摘下
+      ctx.deleted_pages_.push_back(is_right ? sibling_id : now_id);
       ctx.write_set_.pop_back();
       DeleteEntry(ctx, internal_key);
     } else {
@@ -461,6 +644,7 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
           now->SetKeyAt(1, internal_key);
           now->SetValueAt(0, sibling->ValueAt(sibling->GetSize() - 1));
           parent_page->SetKeyAt(internal_id, sibling->KeyAt(sibling->GetSize() - 1));
+          sibling->SetHighKey(sibling->KeyAt(sibling->GetSize() - 1));
           sibling->IncreaseSize(-1);
           now->IncreaseSize(1);
         } else {
@@ -475,6 +659,7 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
           now->IncreaseSize(1);
           sibling->IncreaseSize(-1);
           parent_page->SetKeyAt(internal_id, now->KeyAt(0));
+          sibling->SetHighKey(now->KeyAt(0));
         }
       } else {
         // 右兄弟
@@ -489,6 +674,7 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
             sibling->SetValueAt(i - 1, sibling->ValueAt(i));
           }
           parent_page->SetKeyAt(internal_id, sibling->KeyAt(0));
+          now->SetHighKey(sibling->KeyAt(0));
           sibling->IncreaseSize(-1);
           now->IncreaseSize(1);
         } else {
@@ -501,6 +687,7 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
             sibling->SetValueAt(i - 1, sibling->ValueAt(i));
           }
           parent_page->SetKeyAt(internal_id, sibling->KeyAt(0));
+          now->SetHighKey(sibling->KeyAt(0));
           sibling->IncreaseSize(-1);
           now->IncreaseSize(1);
         }
@@ -510,6 +697,26 @@ void BPLUSTREE_TYPE::DeleteEntry(Context &ctx, const KeyType &key) {
 }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
+  // 乐观删除: 只给叶子加写锁, 删完不会下溢(或者key不存在)就在叶子里解决
+  if (auto leaf_guard = FindLeafWriteOptimistic(key, false); leaf_guard.has_value()) {
+    const auto *leaf = leaf_guard->template As<LeafPage>();
+    int pos = leaf->KeyIndex(key, comparator_);
+    if (pos == leaf->GetSize() || comparator_(key, leaf->KeyAt(pos)) != 0) {
+      return;
+    }
+    if (leaf->GetSize() > leaf->GetMinSize()) {
+      auto *leaf_page = leaf_guard->template AsMut<LeafPage>();
+      for (int i = pos + 1; i < leaf_page->GetSize(); i++) {
+        leaf_page->SetKeyAt(i - 1, leaf_page->KeyAt(i));
+        leaf_page->SetValueAt(i - 1, leaf_page->ValueAt(i));
+      }
+      leaf_page->IncreaseSize(-1);
+      return;
+    }
+    // 叶子会下溢, 合并或借用要改父节点, 放开叶子从头悲观地加锁
+  }
+  // 等没插完分隔key的分裂都插完, 合并和借用只用看父节点
+  std::unique_lock<std::shared_mutex> structure(structure_latch_);
   // Declaration of context instance.
   Context ctx;
   ctx.header_page_.emplace(bpm_->FetchPageWrite(header_page_id_));
@@ -518,37 +725,209 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   if (page_id == INVALID_PAGE_ID) {
     return;
   }
-  ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
+  ctx.write_set_.push_back(FetchChildWrite(*ctx.header_page_, 0, page_id));
   auto *page = ctx.write_set_.back().AsMut<BPlusTreePage>();
   while (!page->IsLeafPage()) {
     auto *internal_page = reinterpret_cast<InternalPage *>(page);
-    bool found = false;
-    for (int i = 1; i < internal_page->GetSize(); ++i) {
-      if (comparator_(key, internal_page->KeyAt(i)) < 0) {
-        found = true;
-        page_id = internal_page->ValueAt(i - 1);
-        ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
-        page = ctx.write_set_.back().AsMut<BPlusTreePage>();
-        if (page->GetSize() > page->GetMinSize()) {
-          // 释放锁
-          ReleaseLock(ctx);
-        }
-        break;
+    int slot = internal_page->Lookup(key, comparator_);
+    page_id = internal_page->ValueAt(slot);
+    ctx.write_set_.push_back(FetchChildWrite(ctx.write_set_.back(), slot, page_id));
+    page = ctx.write_set_.back().AsMut<BPlusTreePage>();
+    if (page->GetSize() > page->GetMinSize()) {
+      // 释放锁
+      ReleaseLock(ctx);
+    }
+  }
+  // 叶子节点就是ctx.write_set_的最后一个
+  DeleteEntry(ctx, key);
+  // 所有latch释放之后再删除摘下的页面. 还被别的线程pin住的页面删除失败, 只是浪费一页空间
+  ctx.write_set_.clear();
+  ctx.header_page_ = std::nullopt;
+  for (auto deleted_page_id : ctx.deleted_pages_) {
+    bpm_->DeletePage(deleted_page_id);
+  }
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+namespace {
+
+/**
+ * Sizes of the pages n entries are packed into, capacity entries each. If the last page would be below min_size, the
+ * last two pages are merged, or split evenly if the entries don't fit into one page of max_size.
+ */
+auto PackSizes(size_t n, int capacity, int min_size, int max_size) -> std::vector<int> {
+  std::vector<int> sizes(n / capacity, capacity);
+  if (n % capacity != 0) {
+    sizes.push_back(static_cast<int>(n % capacity));
+  }
+  if (sizes.size() >= 2 && sizes.back() < min_size) {
+    int total = sizes[sizes.size() - 2] + sizes.back();
+    sizes.pop_back();
+    sizes.back() = total <= max_size ? total : total - total / 2;
+    if (total > max_size) {
+      sizes.push_back(total / 2);
+    }
+  }
+  return sizes;
+}
+
+/** Entries to fill a page with: fill_factor of max_size, but at least min_size. */
+auto FillCapacity(double fill_factor, int min_size, int max_size) -> int {
+  return std::clamp(static_cast<int>(fill_factor * max_size), std::max(min_size, 1), max_size);
+}
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) -> bool {
+  BUSTUB_ENSURE(fill_factor > 0 && fill_factor <= 1, "fill factor must be in (0, 1]");
+  auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+  if (header_guard.As<BPlusTreeHeaderPage>()->root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+  // 每一层记下每个页面的第一个key和page id, 就是上一层的kv
+  std::vector<std::pair<KeyType, page_id_t>> level;
+
+  // 叶子层边读边写, 只拿着最后两个叶子, 最后一个叶子不满时和前一个匀一下
+  WritePageGuard prev_guard;
+  WritePageGuard cur_guard;
+  LeafPage *prev = nullptr;
+  LeafPage *cur = nullptr;
+  int capacity = 0;
+  KeyType key;
+  ValueType value;
+  while (next(&key, &value)) {
+    if (cur != nullptr && cur->GetSize() > 0) {
+      int diff = comparator_(key, cur->KeyAt(cur->GetSize() - 1));
+      BUSTUB_ASSERT(diff >= 0, "bulk loaded entries must be sorted");
+      if (diff == 0) {
+        continue;
       }
     }
-    if (!found) {
-      found = true;
-      page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
-      ctx.write_set_.push_back(bpm_->FetchPageWrite(page_id));
-      page = ctx.write_set_.back().AsMut<BPlusTreePage>();
-      if (page->GetSize() > page->GetMinSize()) {
-        // 释放锁
-        ReleaseLock(ctx);
+    if (cur == nullptr || cur->GetSize() == capacity) {
+      page_id_t page_id;
+      auto guard = bpm_->NewWriteGuarded(&page_id);
+      auto *leaf = guard.AsMut<LeafPage>();
+      leaf->SetPageType(IndexPageType::LEAF_PAGE);
+      leaf->SetMaxSize(leaf_max_size_);
+      leaf->SetLevel(0);
+      leaf->SetSize(0);
+      leaf->SetNextPageId(INVALID_PAGE_ID);
+      capacity = FillCapacity(fill_factor, leaf->GetMinSize(), leaf->GetRealMax());
+      if (cur != nullptr) {
+        cur->SetNextPageId(page_id);
+        cur->SetHighKey(key);
       }
+      prev_guard = std::move(cur_guard);
+      prev = cur;
+      cur_guard = std::move(guard);
+      cur = leaf;
+      level.emplace_back(key, page_id);
     }
+    cur->SetKeyAt(cur->GetSize(), key);
+    cur->SetValueAt(cur->GetSize(), value);
+    cur->IncreaseSize(1);
   }
-  // 叶子节点就是ctx.write_set_的最后一个
-  DeleteEntry(ctx, key);
+  if (level.empty()) {
+    return true;
+  }
+  if (prev != nullptr && cur->GetSize() < cur->GetMinSize()) {
+    int total = prev->GetSize() + cur->GetSize();
+    if (total <= prev->GetRealMax()) {
+      // 整个并进前一个叶子
+      for (int i = 0; i < cur->GetSize(); ++i) {
+        prev->SetKeyAt(prev->GetSize() + i, cur->KeyAt(i));
+        prev->SetValueAt(prev->GetSize() + i, cur->ValueAt(i));
+      }
+      prev->IncreaseSize(cur->GetSize());
+      prev->SetNextPageId(INVALID_PAGE_ID);
+      cur_guard.Drop();
+      bpm_->DeletePage(level.back().second);
+      level.pop_back();
+    } else {
+      // 从前一个叶子的尾巴挪几个到最后一个叶子的头上
+      int moved = prev->GetSize() - (total - total / 2);
+      for (int i = cur->GetSize() - 1; i >= 0; --i) {
+        cur->SetKeyAt(i + moved, cur->KeyAt(i));
+        cur->SetValueAt(i + moved, cur->ValueAt(i));
+      }
+      for (int i = 0; i < moved; ++i) {
+        cur->SetKeyAt(i, prev->KeyAt(prev->GetSize() - moved + i));
+        cur->SetValueAt(i, prev->ValueAt(prev->GetSize() - moved + i));
+      }
+      prev->IncreaseSize(-moved);
+      cur->IncreaseSize(moved);
+      prev->SetHighKey(cur->KeyAt(0));
+      level.back().first = cur->KeyAt(0);
+    }
+  }
+  prev_guard.Drop();
+  cur_guard.Drop();
+
+  // 内部节点一层一层往上建, 直到只剩一个根
+  int height = 0;
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> upper;
+    size_t next_child = 0;
+    ++height;
+    // 拿着同一层的前一个页面, 好把它连到下一个页面上
+    WritePageGuard left_guard;
+    InternalPage *left = nullptr;
+    int max_size = internal_max_size_;
+    for (int size : PackSizes(level.size(), FillCapacity(fill_factor, (max_size + 1) / 2, max_size),
+                              (max_size + 1) / 2, max_size)) {
+      page_id_t page_id;
+      auto guard = bpm_->NewWriteGuarded(&page_id);
+      auto *internal_page = guard.AsMut<InternalPage>();
+      internal_page->SetPageType(IndexPageType::INTERNAL_PAGE);
+      internal_page->SetMaxSize(internal_max_size_);
+      internal_page->SetLevel(height);
+      internal_page->SetNextPageId(INVALID_PAGE_ID);
+      internal_page->SetSize(size);
+      if (left != nullptr) {
+        left->SetNextPageId(page_id);
+        left->SetHighKey(level[next_child].first);
+      }
+      upper.emplace_back(level[next_child].first, page_id);
+      // 第0个key用不到, 顺手也写上
+      for (int i = 0; i < size; ++i, ++next_child) {
+        internal_page->SetKeyAt(i, level[next_child].first);
+        internal_page->SetValueAt(i, level[next_child].second);
+      }
+      left_guard = std::move(guard);
+      left = internal_page;
+    }
+    level = std::move(upper);
+  }
+  header_guard.AsMut<BPlusTreeHeaderPage>()->root_page_id_ = level[0].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchChildRead(const ReadPageGuard &parent, int slot, page_id_t child_id) -> ReadPageGuard {
+  if (swizzle_) {
+    return bpm_->FetchChildRead(parent, slot, child_id);
+  }
+  return bpm_->FetchPageRead(child_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchChildOptimistic(const OptimisticReadGuard &parent, int slot, page_id_t child_id)
+    -> OptimisticReadGuard {
+  if (swizzle_) {
+    return bpm_->FetchChildOptimistic(parent, slot, child_id);
+  }
+  return bpm_->FetchPageOptimistic(child_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchChildWrite(const WritePageGuard &parent, int slot, page_id_t child_id) -> WritePageGuard {
+  if (swizzle_) {
+    return bpm_->FetchChildWrite(parent, slot, child_id);
+  }
+  return bpm_->FetchPageWrite(child_id);
 }
 
 /*****************************************************************************
@@ -567,12 +946,12 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     return INDEXITERATOR_TYPE(bpm_, INVALID_PAGE_ID, -1);
   }
   auto page_id = header_page->root_page_id_;
-  auto page_guard = bpm_->FetchPageRead(page_id);
+  ReadPageGuard page_guard = FetchChildRead(header_guard, 0, page_id);
   const auto *page = page_guard.As<BPlusTreePage>();
   while (!page->IsLeafPage()) {
     const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
     page_id = internal_page->ValueAt(0);
-    page_guard = bpm_->FetchPageRead(page_id);
+    page_guard = FetchChildRead(page_guard, 0, page_id);
     page = page_guard.As<BPlusTreePage>();
   }
   page_guard.Drop();
@@ -581,45 +960,25 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
 /*
  * Input parameter is low key, find the leaf page that contains the input key
  * first, then construct index iterator
- * @return : index iterator
+ * @return : index iterator at the first key that is not less than the input
+ * key, End() if there is none
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  auto header_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+  auto leaf_guard = FindLeafOptimistic(key);
+  if (!leaf_guard.has_value()) {
     return INDEXITERATOR_TYPE(bpm_, INVALID_PAGE_ID, -1);
   }
-  auto page_id = header_page->root_page_id_;
-  auto page_guard = bpm_->FetchPageRead(page_id);
-  const auto *page = page_guard.As<BPlusTreePage>();
-  while (!page->IsLeafPage()) {
-    const auto *internal_page = reinterpret_cast<const InternalPage *>(page);
-    bool found = false;
-    for (int i = 1; i < internal_page->GetSize(); ++i) {
-      if (comparator_(key, internal_page->KeyAt(i)) < 0) {
-        found = true;
-        page_guard = bpm_->FetchPageRead(internal_page->ValueAt(i - 1));
-        page_id = page_guard.PageId();
-        page = page_guard.As<BPlusTreePage>();
-        break;
-      }
-    }
-    if (!found) {
-      found = true;
-      page_guard = bpm_->FetchPageRead(internal_page->ValueAt(internal_page->GetSize() - 1));
-      page_id = page_guard.PageId();
-      page = page_guard.As<BPlusTreePage>();
-    }
-  }
+  auto page_guard = std::move(*leaf_guard);
+  auto page_id = page_guard.PageId();
+  const auto *page = page_guard.template As<BPlusTreePage>();
   const auto *leaf_page = reinterpret_cast<const LeafPage *>(page);
-  int pos;
-  for (pos = 0; pos < leaf_page->GetSize(); pos++) {
-    auto diff = comparator_(key, leaf_page->KeyAt(pos));
-    if (diff == 0) {
-      break;
-    }
-    if (diff < 0) {
+  int pos = leaf_page->KeyIndex(key, comparator_);
+  if (pos == leaf_page->GetSize()) {
+    // 叶子里的key都比key小, 从下一个叶子的开头开始
+    page_id = leaf_page->GetNextPageId();
+    pos = 0;
+    if (page_id == INVALID_PAGE_ID) {
       return INDEXITERATOR_TYPE(bpm_, INVALID_PAGE_ID, -1);
     }
   }
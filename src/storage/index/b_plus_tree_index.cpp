@@ -11,13 +11,18 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "storage/index/external_sorter.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
-    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
+    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()), bpm_(buffer_pool_manager) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
   container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
@@ -51,6 +56,69 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const std::vector<char> &lower, bool lower_inclusive,
+                                     const std::vector<char> &upper, bool upper_inclusive, std::vector<RID> *result,
+                                     [[maybe_unused]] Transaction *transaction) {
+  // 比key还长的界截断成key的长度, 截断后的范围包含原来的范围, 多出来的key由调用者过滤
+  size_t lower_size = std::min(lower.size(), sizeof(KeyType));
+  size_t upper_size = std::min(upper.size(), sizeof(KeyType));
+  lower_inclusive = lower_inclusive || lower_size < lower.size();
+  upper_inclusive = upper_inclusive || upper_size < upper.size();
+  auto iter = container_->Begin();
+  if (lower_size > 0) {
+    // 前缀后面补0, 是所有带这个前缀的key里最小的
+    KeyType key;
+    key.SetFromData(lower.data(), lower_size);
+    iter = container_->Begin(key);
+  }
+  for (; !iter.IsEnd(); ++iter) {
+    const auto &[key, rid] = *iter;
+    if (upper_size > 0) {
+      int diff = memcmp(key.data_, upper.data(), upper_size);
+      if (diff > 0 || (diff == 0 && !upper_inclusive)) {
+        // 后面的key只会更大
+        break;
+      }
+    }
+    if (lower_size > 0 && !lower_inclusive && memcmp(key.data_, lower.data(), lower_size) == 0) {
+      continue;
+    }
+    if (rid.GetPageId() != INVALID_PAGE_ID) {
+      result->push_back(rid);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction,
+                                    size_t sort_run_size) -> bool {
+  if (!container_->IsEmpty()) {
+    return false;
+  }
+  struct Entry {
+    KeyType key_;
+    ValueType value_;
+  };
+  auto less = [this](const Entry &a, const Entry &b) { return comparator_(a.key_, b.key_) < 0; };
+  ExternalSorter<Entry, decltype(less)> sorter(bpm_, less, sort_run_size);
+  Tuple key;
+  Entry entry;
+  while (next(&key, &entry.value_)) {
+    entry.key_.SetFromKey(key);
+    sorter.Add(entry);
+  }
+  sorter.Finish();
+  return container_->BulkLoad([&sorter, &entry](KeyType *index_key, ValueType *value) {
+    if (!sorter.Next(&entry)) {
+      return false;
+    }
+    *index_key = entry.key_;
+    *value = entry.value_;
+    return true;
+  });
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
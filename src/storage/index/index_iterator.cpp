@@ -45,7 +45,11 @@ auto INDEXITERATOR_TYPE::operator=(IndexIterator &&iter) noexcept -> IndexIterat
   return *this;
 }
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return page_->PairAt(pos_); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  // 叶子里key和value分开存, 没有现成的pair可以返回
+  item_ = {page_->KeyAt(pos_), page_->ValueAt(pos_)};
+  return item_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   if (page_id_ == INVALID_PAGE_ID) {
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_encoder.h"
+
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** Append the lowest bytes bytes of v, most significant first. */
+void AppendBigEndian(uint64_t v, size_t bytes, std::vector<char> *key) {
+  for (size_t i = bytes; i > 0; --i) {
+    key->push_back(static_cast<char>(v >> (8 * (i - 1))));
+  }
+}
+
+/** Append a signed integer of bytes bytes with its sign bit flipped. */
+void AppendSigned(int64_t v, size_t bytes, std::vector<char> *key) {
+  AppendBigEndian(static_cast<uint64_t>(v) ^ (UINT64_C(1) << (8 * bytes - 1)), bytes, key);
+}
+
+}  // namespace
+
+void KeyEncoder::Encode(const Value &value, std::vector<char> *key) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      AppendSigned(value.GetAs<int8_t>(), 1, key);
+      break;
+    case TypeId::SMALLINT:
+      AppendSigned(value.GetAs<int16_t>(), 2, key);
+      break;
+    case TypeId::INTEGER:
+      AppendSigned(value.GetAs<int32_t>(), 4, key);
+      break;
+    case TypeId::BIGINT:
+      AppendSigned(value.GetAs<int64_t>(), 8, key);
+      break;
+    case TypeId::TIMESTAMP:
+      // NULL是最大值, 加一之后回绕成0, 排在最前面
+      AppendBigEndian(value.GetAs<uint64_t>() + 1, 8, key);
+      break;
+    case TypeId::DECIMAL: {
+      auto d = value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      bits = (bits >> 63) != 0 ? ~bits : bits ^ (UINT64_C(1) << 63);
+      AppendBigEndian(bits, 8, key);
+      break;
+    }
+    case TypeId::VARCHAR: {
+      if (value.IsNull()) {
+        key->push_back(0);
+        break;
+      }
+      key->push_back(1);
+      for (char c : value.ToString()) {
+        key->push_back(c);
+        if (c == 0) {
+          key->push_back(static_cast<char>(0xFF));
+        }
+      }
+      key->push_back(0);
+      key->push_back(0);
+      break;
+    }
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "type can't be used in an index key");
+  }
+}
+
+auto KeyEncoder::MaxSize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        size += 1;
+        break;
+      case TypeId::SMALLINT:
+        size += 2;
+        break;
+      case TypeId::INTEGER:
+        size += 4;
+        break;
+      case TypeId::BIGINT:
+      case TypeId::TIMESTAMP:
+      case TypeId::DECIMAL:
+        size += 8;
+        break;
+      case TypeId::VARCHAR:
+        // 标记字节 + 字符 + 结尾的两个0
+        size += 1 + static_cast<size_t>(column.GetLength()) + 2;
+        break;
+      default:
+        throw Exception(ExceptionType::NOT_IMPLEMENTED, "type can't be used in an index key");
+    }
+  }
+  return size;
+}
+
+}  // namespace bustub
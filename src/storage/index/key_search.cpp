@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Load an encoded key as an integer that compares like the key. */
+template <typename T>
+inline auto LoadKey(const char *data) -> T {
+  T v;
+  memcpy(&v, data, sizeof(T));
+  if constexpr (sizeof(T) == sizeof(uint64_t)) {
+    return __builtin_bswap64(v);
+  } else {
+    return __builtin_bswap32(v);
+  }
+}
+
+template <typename T>
+auto CountScalar(const char *keys, int n, const char *key, bool inclusive) -> int {
+  T k = LoadKey<T>(key);
+  int count = 0;
+  // 有序的, 数到第一个不满足的就可以停了
+  while (count < n) {
+    T v = LoadKey<T>(keys + count * sizeof(T));
+    if (v > k || (!inclusive && v == k)) {
+      break;
+    }
+    count++;
+  }
+  return count;
+}
+
+#if defined(__x86_64__)
+
+/*
+ * 键是大端存的无符号整数, 先用shuffle把每个lane的字节反过来, 再翻转符号位, 就可以用有符号比较了.
+ * 一个窗口里的键都比较完, 数一下满足条件的有几个; 键是有序的, 这个数就是位置.
+ */
+
+__attribute__((target("avx2"))) auto CountAvx2x64(const char *keys, int n, const char *key, bool inclusive) -> int {
+  const __m256i bswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                         15, 14, 13, 12, 11, 10, 9, 8);
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i k = _mm256_set1_epi64x(static_cast<int64_t>(LoadKey<uint64_t>(key) ^ INT64_MIN));
+  int count = 0;
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(uint64_t)));
+    v = _mm256_xor_si256(_mm256_shuffle_epi8(v, bswap), sign);
+    // inclusive: v <= k 即 !(v > k); 否则 v < k 即 k > v
+    __m256i gt = inclusive ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(gt));
+    count += inclusive ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+  return count + CountScalar<uint64_t>(keys + i * sizeof(uint64_t), n - i, key, inclusive);
+}
+
+__attribute__((target("avx2"))) auto CountAvx2x32(const char *keys, int n, const char *key, bool inclusive) -> int {
+  const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4,
+                                         11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+  const __m256i k = _mm256_set1_epi32(static_cast<int32_t>(LoadKey<uint32_t>(key) ^ INT32_MIN));
+  int count = 0;
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(uint32_t)));
+    v = _mm256_xor_si256(_mm256_shuffle_epi8(v, bswap), sign);
+    __m256i gt = inclusive ? _mm256_cmpgt_epi32(v, k) : _mm256_cmpgt_epi32(k, v);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(gt));
+    count += inclusive ? 8 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+  return count + CountScalar<uint32_t>(keys + i * sizeof(uint32_t), n - i, key, inclusive);
+}
+
+__attribute__((target("sse4.2"))) auto CountSse42x64(const char *keys, int n, const char *key, bool inclusive) -> int {
+  const __m128i bswap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+  const __m128i k = _mm_set1_epi64x(static_cast<int64_t>(LoadKey<uint64_t>(key) ^ INT64_MIN));
+  int count = 0;
+  int i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(uint64_t)));
+    v = _mm_xor_si128(_mm_shuffle_epi8(v, bswap), sign);
+    __m128i gt = inclusive ? _mm_cmpgt_epi64(v, k) : _mm_cmpgt_epi64(k, v);
+    int mask = _mm_movemask_pd(_mm_castsi128_pd(gt));
+    count += inclusive ? 2 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+  return count + CountScalar<uint64_t>(keys + i * sizeof(uint64_t), n - i, key, inclusive);
+}
+
+__attribute__((target("sse4.2"))) auto CountSse42x32(const char *keys, int n, const char *key, bool inclusive) -> int {
+  const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i sign = _mm_set1_epi32(INT32_MIN);
+  const __m128i k = _mm_set1_epi32(static_cast<int32_t>(LoadKey<uint32_t>(key) ^ INT32_MIN));
+  int count = 0;
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(uint32_t)));
+    v = _mm_xor_si128(_mm_shuffle_epi8(v, bswap), sign);
+    __m128i gt = inclusive ? _mm_cmpgt_epi32(v, k) : _mm_cmpgt_epi32(k, v);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(gt));
+    count += inclusive ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+  return count + CountScalar<uint32_t>(keys + i * sizeof(uint32_t), n - i, key, inclusive);
+}
+
+#endif
+
+auto Supported(KeySearch::Isa isa) -> bool {
+  switch (isa) {
+    case KeySearch::Isa::SCALAR:
+      return true;
+#if defined(__x86_64__)
+    case KeySearch::Isa::SSE42:
+      return __builtin_cpu_supports("sse4.2") != 0;
+    case KeySearch::Isa::AVX2:
+      return __builtin_cpu_supports("avx2") != 0;
+#endif
+    default:
+      return false;
+  }
+}
+
+auto BestIsa() -> KeySearch::Isa {
+  for (auto isa : {KeySearch::Isa::AVX2, KeySearch::Isa::SSE42}) {
+    if (Supported(isa)) {
+      return isa;
+    }
+  }
+  return KeySearch::Isa::SCALAR;
+}
+
+auto Count64Of(KeySearch::Isa isa) -> int (*)(const char *, int, const char *, bool) {
+#if defined(__x86_64__)
+  if (isa == KeySearch::Isa::AVX2) {
+    return CountAvx2x64;
+  }
+  if (isa == KeySearch::Isa::SSE42) {
+    return CountSse42x64;
+  }
+#endif
+  return CountScalar<uint64_t>;
+}
+
+auto Count32Of(KeySearch::Isa isa) -> int (*)(const char *, int, const char *, bool) {
+#if defined(__x86_64__)
+  if (isa == KeySearch::Isa::AVX2) {
+    return CountAvx2x32;
+  }
+  if (isa == KeySearch::Isa::SSE42) {
+    return CountSse42x32;
+  }
+#endif
+  return CountScalar<uint32_t>;
+}
+
+}  // namespace
+
+KeySearch::Isa KeySearch::isa_ = BestIsa();
+KeySearch::CountFunc KeySearch::count64_ = Count64Of(BestIsa());
+KeySearch::CountFunc KeySearch::count32_ = Count32Of(BestIsa());
+
+auto KeySearch::Use(Isa isa) -> bool {
+  if (!Supported(isa)) {
+    return false;
+  }
+  isa_ = isa;
+  count64_ = Count64Of(isa);
+  count32_ = Count32Of(isa);
+  return true;
+}
+
+}  // namespace bustub
@@ -9,11 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 #include "common/config.h"
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -33,18 +35,37 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) { SetMaxSize(max_size);
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
-  return array_[index].first;
+  return Keys()[index];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { Keys()[index] = key; }
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return Values()[index]; }
+
+/*
+ * The first key is invalid, the child is the one before the first key greater
+ * than key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> int {
+  return KeySearch::Search(Keys(), 1, GetSize(), key, comparator, true) - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyEntries(char *dst, const char *src, int size) -> const BPlusTreeInternalPage * {
+  auto *page = reinterpret_cast<BPlusTreeInternalPage *>(dst);
+  const auto *from = reinterpret_cast<const BPlusTreeInternalPage *>(src);
+  memcpy(dst, src, INTERNAL_PAGE_HEADER_SIZE + sizeof(KeyType));
+  memcpy(page->Keys(), from->Keys(), size * sizeof(KeyType));
+  memcpy(page->Values(), from->Values(), size * sizeof(ValueType));
+  return page;
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
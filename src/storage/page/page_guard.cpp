@@ -13,10 +13,7 @@ BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept
 
 void BasicPageGuard::Drop() {
   if (page_ != nullptr) {
-    if (is_dirty_) {
-      bpm_->FlushPage(PageId());
-    }
-    bpm_->UnpinPage(PageId(), false);
+    bpm_->UnpinPage(PageId(), is_dirty_);
   }
   page_ = nullptr;
   bpm_ = nullptr;
@@ -29,11 +26,7 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
   }
   // 释放自己的资源
   if (page_ != nullptr) {
-    if (is_dirty_) {
-      bpm_->FlushPage(PageId());
-      is_dirty_ = false;
-    }
-    bpm_->UnpinPage(PageId(), false);
+    bpm_->UnpinPage(PageId(), is_dirty_);
   }
   bpm_ = that.bpm_;
   page_ = that.page_;
@@ -48,11 +41,7 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
 
 BasicPageGuard::~BasicPageGuard() {
   if (page_ != nullptr) {
-    if (is_dirty_) {
-      bpm_->FlushPage(PageId());
-      is_dirty_ = false;
-    }
-    bpm_->UnpinPage(PageId(), false);
+    bpm_->UnpinPage(PageId(), is_dirty_);
   }
   page_ = nullptr;
   is_dirty_ = false;
@@ -76,12 +65,8 @@ auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &
     return *this;
   }
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->RUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.page_ = nullptr;
   guard_ = std::move(that.guard_);
@@ -90,12 +75,8 @@ auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &
 
 void ReadPageGuard::Drop() {
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->RUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.bpm_ = nullptr;
   guard_.page_ = nullptr;
@@ -104,12 +85,8 @@ void ReadPageGuard::Drop() {
 
 ReadPageGuard::~ReadPageGuard() {
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->RUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.page_ = nullptr;
   guard_.bpm_ = nullptr;
@@ -131,12 +108,8 @@ auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard
     return *this;
   }
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->WUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.page_ = nullptr;
   guard_ = std::move(that.guard_);
@@ -146,12 +119,8 @@ auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard
 
 void WritePageGuard::Drop() {
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->WUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.page_ = nullptr;
   guard_.bpm_ = nullptr;
@@ -160,12 +129,8 @@ void WritePageGuard::Drop() {
 
 WritePageGuard::~WritePageGuard() {
   if (guard_.page_ != nullptr) {
-    if (guard_.is_dirty_) {
-      guard_.bpm_->FlushPage(guard_.PageId());
-      guard_.is_dirty_ = false;
-    }
-    guard_.bpm_->UnpinPage(guard_.PageId(), false);
     guard_.page_->WUnlatch();
+    guard_.bpm_->UnpinPage(guard_.PageId(), guard_.is_dirty_);
   }
   guard_.page_ = nullptr;
   guard_.bpm_ = nullptr;
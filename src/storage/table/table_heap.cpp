@@ -30,6 +30,7 @@ TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
   // Initialize the first table page.
   auto guard = bpm->NewPageGuarded(&first_page_id_);
   last_page_id_ = first_page_id_;
+  page_ids_.push_back(first_page_id_);
   auto first_page = guard.AsMut<TablePage>();
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
@@ -65,6 +66,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
     auto next_page_guard = WritePageGuard{bpm_, npg};
 
     last_page_id_ = next_page_id;
+    page_ids_.push_back(next_page_id);
     page_guard = std::move(next_page_guard);
   }
   auto last_page_id = last_page_id_;
@@ -91,8 +93,8 @@ void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
   page->UpdateTupleMeta(meta, rid);
 }
 
-auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
-  auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+auto TableHeap::GetTuple(RID rid, AccessType access_type) -> std::pair<TupleMeta, Tuple> {
+  auto page_guard = bpm_->FetchPageRead(rid.GetPageId(), access_type);
   auto page = page_guard.As<TablePage>();
   auto [meta, tuple] = page->GetTuple(rid);
   tuple.rid_ = rid;
@@ -115,6 +117,11 @@ auto TableHeap::MakeIterator() -> TableIterator {
   return {this, {first_page_id_, 0}, {last_page_id, page->GetNumTuples()}};
 }
 
+auto TableHeap::GetPageIdAt(size_t idx) -> page_id_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return idx < page_ids_.size() ? page_ids_[idx] : INVALID_PAGE_ID;
+}
+
 auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page_id_, 0}, {INVALID_PAGE_ID, 0}}; }
 
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
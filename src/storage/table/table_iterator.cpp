@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <optional>
 
@@ -24,22 +25,51 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
     : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
   // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
   // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  if (rid_.GetSlotNum() >= page->GetNumTuples()) {
+  uint32_t num_tuples;
+  page_id_t next_page_id;
+  ReadPageMeta(rid_.GetPageId(), &num_tuples, &next_page_id);
+  if (rid_.GetSlotNum() >= num_tuples) {
     rid_ = RID{INVALID_PAGE_ID, 0};
+    return;
   }
+  Prefetch();
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+void TableIterator::ReadPageMeta(page_id_t page_id, uint32_t *num_tuples, page_id_t *next_page_id) {
+  // 只读页头的两个字段, 乐观读就够了: 不pin也不加读锁, 读完验证版本号, 冲突就重读
+  while (true) {
+    auto page_guard = table_heap_->bpm_->FetchPageOptimistic(page_id, AccessType::Scan);
+    auto page = page_guard.As<TablePage>();
+    *num_tuples = page->GetNumTuples();
+    *next_page_id = page->GetNextPageId();
+    if (page_guard.Validate()) {
+      return;
+    }
+  }
+}
+
+void TableIterator::Prefetch() {
+  auto window = scan_prefetch_window.load();
+  prefetched_until_ = std::max(prefetched_until_, page_idx_ + 1);
+  for (; prefetched_until_ <= page_idx_ + window; ++prefetched_until_) {
+    auto page_id = table_heap_->GetPageIdAt(prefetched_until_);
+    if (page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    table_heap_->bpm_->PrefetchPage(page_id);
+  }
+}
+
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_, AccessType::Scan); }
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
+  uint32_t num_tuples;
+  page_id_t next_page_id;
+  ReadPageMeta(rid_.GetPageId(), &num_tuples, &next_page_id);
   auto next_tuple_id = rid_.GetSlotNum() + 1;
 
   if (stop_at_rid_.GetPageId() != INVALID_PAGE_ID) {
@@ -54,15 +84,17 @@ auto TableIterator::operator++() -> TableIterator & {
 
   if (rid_ == stop_at_rid_) {
     rid_ = RID{INVALID_PAGE_ID, 0};
-  } else if (next_tuple_id < page->GetNumTuples()) {
+  } else if (next_tuple_id < num_tuples) {
     // that's fine
   } else {
-    auto next_page_id = page->GetNextPageId();
     // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
     rid_ = RID{next_page_id, 0};
+    ++page_idx_;
   }
 
-  page_guard.Drop();
+  if (!IsEnd()) {
+    Prefetch();
+  }
 
   return *this;
 }
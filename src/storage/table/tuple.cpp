@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -70,12 +71,13 @@ auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> V
 
 auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
     -> Tuple {
-  std::vector<Value> values;
-  values.reserve(key_attrs.size());
+  // The key is not laid out like a tuple of the key schema: its data is the encoding of the key columns, which
+  // indexes compare byte by byte.
+  Tuple key;
   for (auto idx : key_attrs) {
-    values.emplace_back(this->GetValue(&schema, idx));
+    KeyEncoder::Encode(this->GetValue(&schema, idx), &key.data_);
   }
-  return {values, &key_schema};
+  return key;
 }
 
 auto Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const -> const char * {
@@ -0,0 +1,61 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include "buffer/arc_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+
+  // Scenario: frames 0-3 hold pages 10-13. Page 10 is accessed twice and moves to T2.
+  // T1 is [1,2,3], T2 is [0].
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Get, 10 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(0, AccessType::Get, 10);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+
+  // Scenario: T1 is larger than its target size 0, so its LRU page 11 is evicted and goes to B1.
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 11 comes back. A hit in B1 grows the target size of T1, and the page goes to T2.
+  // T1 is [2,3], T2 is [0,1].
+  replacer.RecordAccess(1, AccessType::Get, 11);
+  replacer.SetEvictable(1, true);
+  ASSERT_EQ(1, replacer.GetTargetRecentSize());
+
+  // Scenario: T1 is evicted from until it is at its target size, then T2.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 10 comes back. A hit in B2 shrinks the target size of T1.
+  replacer.RecordAccess(0, AccessType::Get, 10);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+
+  // Scenario: a scan does not move a page to T2 and a page from a ghost list read by a scan does not adapt the target.
+  replacer.RecordAccess(3, AccessType::Scan, 13);
+  replacer.RecordAccess(2, AccessType::Scan, 12);
+  replacer.SetEvictable(2, true);
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+  ASSERT_EQ(std::vector<frame_id_t>({3, 2, 1, 0}), replacer.Victims(4));
+
+  // Scenario: pinned frames are skipped.
+  replacer.SetEvictable(3, false);
+  replacer.SetEvictable(2, false);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(1, replacer.Size());
+}
+
+}  // namespace bustub
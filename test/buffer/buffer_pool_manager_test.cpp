@@ -12,12 +12,18 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -145,4 +151,574 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Many threads missing in a pool much smaller than the working set must always see the page contents last written
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const size_t num_pages = 64;
+  const size_t num_threads = 8;
+  const size_t rounds = 200;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(static_cast<page_id_t>(i), page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&bpm, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dis(0, num_pages - 1);
+      char expected[BUSTUB_PAGE_SIZE];
+      for (size_t r = 0; r < rounds; ++r) {
+        auto page_id = dis(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, BUSTUB_PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, r % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ShardedTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const size_t num_shards = 3;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_shards);
+  ASSERT_EQ(num_shards, bpm->GetNumShards());
+
+  // Scenario: new pages are spread round-robin over the shards, so the first ids are dense.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(static_cast<page_id_t>(i), page_ids[i]);
+  }
+
+  // Scenario: every frame of every shard is pinned.
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: freeing a frame in one shard is enough for NewPage, and the new page lands in that shard.
+  EXPECT_TRUE(bpm->UnpinPage(4, true));
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(4 % num_shards, page_id_temp % num_shards);
+
+  // Scenario: page 4 was written back when it was evicted and can be fetched once its shard has a free frame again.
+  EXPECT_EQ(nullptr, bpm->FetchPage(4));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  page = bpm->FetchPage(4);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 4"));
+  EXPECT_TRUE(bpm->UnpinPage(4, false));
+
+  // Scenario: pages of other shards are unaffected.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    if (page_id == 4) {
+      continue;
+    }
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    char expected[BUSTUB_PAGE_SIZE];
+    snprintf(expected, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const size_t num_pages = 16;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  // Keep the prefetch reads in flight long enough to observe them.
+  disk_manager->SetLatency(100);
+
+  // Scenario: pages in the pool are not prefetched.
+  EXPECT_FALSE(bpm->PrefetchPage(num_pages - 1));
+
+  // Scenario: at most a quarter of the frames are used for reads in flight.
+  EXPECT_TRUE(bpm->PrefetchPage(0));
+  EXPECT_TRUE(bpm->PrefetchPage(1));
+  EXPECT_FALSE(bpm->PrefetchPage(2));
+
+  // Scenario: fetching a prefetched page waits for the read and returns its content.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  auto *page1 = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(0, strcmp(page1->GetData(), "page 1"));
+
+  // Scenario: once their reads are done, prefetched pages only hold the pins of the callers.
+  EXPECT_TRUE(bpm->PrefetchPage(2));
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_EQ(1, page1->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  auto *page2 = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page2);
+  EXPECT_EQ(0, strcmp(page2->GetData(), "page 2"));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushDirtyVictimsTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    pages.push_back(page);
+  }
+
+  // Scenario: pinned pages are never flushed in the background.
+  EXPECT_EQ(0, bpm->FlushDirtyVictims());
+
+  // Scenario: only the next victims are cleaned, i.e. a quarter of the pool, oldest first.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), true));
+  }
+  EXPECT_EQ(buffer_pool_size / 4, bpm->FlushDirtyVictims());
+  EXPECT_EQ(buffer_pool_size / 4, bpm->GetNumFlushedPages());
+  char data[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(i >= buffer_pool_size / 4, pages[i]->IsDirty());
+    EXPECT_EQ(0, pages[i]->GetPinCount());
+    if (i < buffer_pool_size / 4) {
+      disk_manager->ReadPage(static_cast<page_id_t>(i), data);
+      EXPECT_EQ(0, strcmp(data, pages[i]->GetData()));
+    }
+  }
+
+  // Scenario: evicting the cleaned pages does not need a foreground write-back.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size / 4; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(0, bpm->GetNumDirtyVictims());
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, bpm->GetNumDirtyVictims());
+
+  // Scenario: the flush thread keeps cleaning pages while it runs.
+  bpm->RunFlushThread(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  bpm->StopFlushThread();
+  EXPECT_LT(buffer_pool_size / 4, bpm->GetNumFlushedPages());
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const size_t buffer_pool_size = 16;
+
+  for (bool use_huge_pages : {false, true}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 1, use_huge_pages);
+
+    // Scenario: every frame is page aligned and the frames are contiguous in one arena.
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % BUSTUB_PAGE_SIZE);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page) % BUSTUB_CACHELINE_SIZE);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+      pages.push_back(page);
+    }
+    std::vector<char *> frames;
+    for (auto *page : pages) {
+      frames.push_back(page->GetData());
+    }
+    std::sort(frames.begin(), frames.end());
+    for (size_t i = 1; i < frames.size(); ++i) {
+      EXPECT_EQ(frames[i - 1] + BUSTUB_PAGE_SIZE, frames[i]);
+    }
+
+    // Scenario: pages still round trip through the disk.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), true));
+    }
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      ASSERT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    }
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->FetchPage(static_cast<page_id_t>(i));
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(i)).c_str()));
+      ASSERT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), false));
+    }
+
+    bpm = nullptr;
+    disk_manager->ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 48;
+  const size_t num_threads = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: lock-free hits race with misses that evict frames; every fetch must return the page it asked for and
+  // see the counter updates of all other threads.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&bpm, t] {
+      std::mt19937 gen(t);
+      // most accesses go to a hot set that fits in the pool
+      std::uniform_int_distribution<page_id_t> hot(0, 7);
+      std::uniform_int_distribution<page_id_t> all(0, num_pages - 1);
+      for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = i % 4 == 0 ? all(gen) : hot(gen);
+        auto guard = bpm->FetchPageWrite(page_id);
+        ASSERT_NE(nullptr, guard.GetData());
+        page_id_t stored;
+        memcpy(&stored, guard.GetData(), sizeof(stored));
+        ASSERT_EQ(page_id, stored);
+        ++*reinterpret_cast<int *>(guard.AsMut<char>() + sizeof(page_id_t));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int total = 0;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto guard = bpm->FetchPageRead(static_cast<page_id_t>(i));
+    total += *reinterpret_cast<const int *>(guard.As<char>() + sizeof(page_id_t));
+  }
+  EXPECT_EQ(num_threads * 2000, total);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+
+  for (auto policy :
+       {ReplacerPolicy::LRUK, ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    SCOPED_TRACE(ReplacerPolicyToString(policy));
+    ASSERT_EQ(policy, ParseReplacerPolicy(ReplacerPolicyToString(policy)));
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm =
+        std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 1, false, policy);
+    ASSERT_EQ(policy, bpm->GetReplacerPolicy());
+
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: pinned pages are never evicted, whatever the policy.
+    auto *pinned = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, pinned);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(1, num_pages - 1);
+    for (int i = 0; i < 500; ++i) {
+      page_id_t page_id = i % 2 == 0 ? dist(gen) : i % 4;
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    EXPECT_EQ(0, pinned->GetPageId());
+    ASSERT_TRUE(bpm->UnpinPage(0, false));
+    EXPECT_GT(bpm->GetNumMisses(), 0);
+
+    // Scenario: when every frame is pinned there is no victim.
+    std::vector<page_id_t> pinned_ids;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(static_cast<page_id_t>(i)));
+      pinned_ids.push_back(static_cast<page_id_t>(i));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(static_cast<page_id_t>(num_pages - 1)));
+    for (auto page_id : pinned_ids) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    bpm = nullptr;
+    disk_manager->ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: creating and flushing pages is neither a hit nor a miss.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, i < buffer_pool_size));
+    page_ids.push_back(page_id);
+    if (i + 1 == buffer_pool_size) {
+      bpm->FlushAllPages();
+    }
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(buffer_pool_size, stats.evictions_);
+  EXPECT_EQ(0, stats.dirty_victims_);
+  EXPECT_EQ(buffer_pool_size, stats.disk_write_latency_.count_);
+
+  // Scenario: the last pages are resident, the first ones have to be read.
+  bpm->ResetStats();
+  for (size_t i = buffer_pool_size; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_DOUBLE_EQ(1.0, stats.HitRate());
+
+  auto *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.fetch_miss_latency_.count_);
+  EXPECT_EQ(1, stats.disk_read_latency_.count_);
+  EXPECT_GT(stats.fetch_miss_latency_.max_, 0);
+  EXPECT_LE(stats.fetch_miss_latency_.Percentile(0.5), stats.fetch_miss_latency_.max_);
+
+  // Scenario: with every frame pinned the next miss finds no evictable frame.
+  std::vector<page_id_t> pinned = {page_ids[0]};
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[page_ids.size() - i]));
+    pinned.push_back(page_ids[page_ids.size() - i]);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[1]));
+  EXPECT_EQ(1, bpm->GetStats().no_evictable_frames_);
+  for (auto page_id : pinned) {
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.evictions_ + stats.no_evictable_frames_);
+  EXPECT_EQ(0, stats.fetch_miss_latency_.count_ + stats.disk_read_latency_.count_);
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeletePageReuseTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  for (page_id_t i = 0; i < 10; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a pinned page cannot be deleted.
+  ASSERT_NE(nullptr, bpm->FetchPage(9));
+  EXPECT_FALSE(bpm->DeletePage(9));
+  ASSERT_TRUE(bpm->UnpinPage(9, false));
+
+  // Scenario: deleted pages, resident or evicted, are deallocated and their ids are reused lowest first.
+  EXPECT_TRUE(bpm->DeletePage(9));
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_FALSE(disk_manager->IsAllocated(3));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  for (page_id_t expected : {3, 9, 10}) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(0, page->GetData()[0]);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // The other pages are untouched.
+  for (page_id_t page_id : {0, 4, 8}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 16;
+  const size_t num_shards = 2;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                 num_shards, false, ReplacerPolicy::LRUK, max_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(max_pool_size, bpm->GetPoolCapacity());
+  EXPECT_THROW(bpm->Resize(num_shards - 1), Exception);
+  EXPECT_THROW(bpm->Resize(max_pool_size + 1), Exception);
+
+  // Scenario: growing the pool adds free frames.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  bpm->Resize(8);
+  EXPECT_EQ(8, bpm->GetPoolSize());
+  for (size_t i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: shrinking keeps pinned pages in their frames until they are unpinned.
+  bpm->Resize(2);
+  EXPECT_EQ(2, bpm->GetPoolSize());
+  for (auto id : page_ids) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(id)).c_str()));
+    ASSERT_TRUE(bpm->UnpinPage(id, false));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (auto id : page_ids) {
+    ASSERT_TRUE(bpm->UnpinPage(id, true));
+  }
+
+  // Unpinned pages past the new size are written back and their frames released, so at most two pages stay resident.
+  for (auto id : page_ids) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(id)).c_str()));
+    ASSERT_TRUE(bpm->UnpinPage(id, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.pool_size_);
+  EXPECT_GE(stats.misses_, page_ids.size() - 2);
+
+  // Scenario: fetches keep working while the pool is resized concurrently.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&bpm, &page_ids, &stop, tid]() {
+      std::mt19937 gen(tid);
+      while (!stop) {
+        page_id_t id = page_ids[gen() % page_ids.size()];
+        auto *page = bpm->FetchPage(id);
+        if (page == nullptr) {
+          // Every frame of the shard is pinned by the other threads.
+          continue;
+        }
+        page->RLatch();
+        EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(id)).c_str()));
+        page->RUnlatch();
+        ASSERT_TRUE(bpm->UnpinPage(id, false));
+      }
+    });
+  }
+  for (int round = 0; round < 100; ++round) {
+    bpm->Resize(round % 2 == 0 ? max_pool_size : num_shards);
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
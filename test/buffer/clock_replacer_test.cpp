@@ -19,44 +19,91 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  // Scenario: add six elements to the replacer. Their reference bits are set.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
   EXPECT_EQ(6, clock_replacer.Size());
 
-  // Scenario: get three victims from the clock.
+  // Scenario: get three victims from the clock. The first sweep clears all reference bits.
   int value;
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(3, value);
 
-  // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  // Scenario: pin 5 and access 4. We expect that the reference bit of 4 will be set to 1, so 6 goes first.
+  clock_replacer.SetEvictable(5, false);
   EXPECT_EQ(2, clock_replacer.Size());
-
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
-
-  // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.RecordAccess(4);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Evict(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+
+  // Scenario: a frame first seen by a scan has a clear reference bit and goes before a referenced one.
+  clock_replacer.RecordAccess(2);
+  clock_replacer.RecordAccess(1, AccessType::Scan);
+  clock_replacer.SetEvictable(1, true);
+  clock_replacer.SetEvictable(2, true);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a rejected candidate stays in the replacer.
+  ASSERT_FALSE(clock_replacer.Evict(&value, [](frame_id_t) { return false; }));
+  EXPECT_EQ(1, clock_replacer.Size());
+  clock_replacer.Remove(2);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, ConcurrentEvictTest) {
+  const size_t num_frames = 1000;
+  const size_t num_threads = 4;
+  ClockReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    clock_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    clock_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+
+  // No frame is evicted twice, while other threads keep setting reference bits.
+  std::vector<std::vector<frame_id_t>> evicted(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      frame_id_t frame_id;
+      while (clock_replacer.Evict(&frame_id)) {
+        evicted[tid].push_back(frame_id);
+        clock_replacer.RecordAccess(static_cast<frame_id_t>((frame_id * 7) % num_frames));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // an Evict() call only sweeps a bounded number of frames, it may give up while other threads move the hand
+  frame_id_t frame_id;
+  while (clock_replacer.Evict(&frame_id)) {
+    evicted[0].push_back(frame_id);
+  }
+  std::vector<bool> seen(num_frames, false);
+  size_t total = 0;
+  for (const auto &frames : evicted) {
+    for (auto frame_id : frames) {
+      ASSERT_FALSE(seen[frame_id]);
+      seen[frame_id] = true;
+      total++;
+    }
+  }
+  EXPECT_EQ(num_frames, total);
+  EXPECT_EQ(0, clock_replacer.Size());
 }
 
 }  // namespace bustub
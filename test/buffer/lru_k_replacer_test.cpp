@@ -95,4 +95,69 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, ScaleTest) {
+  const size_t num_frames = 100000;
+  LRUKReplacer lru_replacer(num_frames, 2);
+
+  // Scenario: every frame is accessed once, odd frames are accessed a second time in reverse order.
+  for (size_t i = 0; i < num_frames; ++i) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    lru_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+  for (size_t i = num_frames; i > 0; --i) {
+    if ((i - 1) % 2 == 1) {
+      lru_replacer.RecordAccess(static_cast<frame_id_t>(i - 1));
+    }
+  }
+  ASSERT_EQ(num_frames, lru_replacer.Size());
+
+  // Scenario: even frames have +inf k-distance and go first in LRU order. Odd frames follow, ordered by their second
+  // most recent (i.e. first) access.
+  int value;
+  for (size_t i = 0; i < num_frames; i += 2) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(static_cast<frame_id_t>(i), value);
+  }
+  for (size_t i = 1; i < num_frames; i += 2) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(static_cast<frame_id_t>(i), value);
+  }
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(6, 2);
+
+  // Scenario: frames 0 and 1 are hot pages of point lookups, frame 1 is also touched by a scan.
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+
+  // Scenario: a scan passes over frames 2, 3 and 4, touching each of them several times.
+  for (frame_id_t fid = 2; fid <= 4; ++fid) {
+    lru_replacer.RecordAccess(fid, AccessType::Scan);
+    lru_replacer.RecordAccess(fid, AccessType::Scan);
+    lru_replacer.RecordAccess(fid, AccessType::Scan);
+  }
+  // Frame 5 is first scanned, then read by a point lookup, so it is no longer a scan-only frame.
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.RecordAccess(5, AccessType::Get);
+  for (frame_id_t fid = 0; fid < 6; ++fid) {
+    lru_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(6, lru_replacer.Size());
+
+  // Scenario: scanned frames are evicted first in scan order, then frames with +inf k-distance in LRU order (the scan
+  // access to frame 1 did not count toward its history), then the hot frame.
+  int value;
+  for (frame_id_t expected : {2, 3, 4, 1, 5, 0}) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
 }  // namespace bustub
@@ -0,0 +1,115 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable table(8);
+  frame_id_t frame_id = -1;
+
+  // Scenario: look up, replace and erase entries.
+  EXPECT_FALSE(table.Find(0, &frame_id));
+  table.Insert(0, 3);
+  table.Insert(8, 5);
+  EXPECT_EQ(2, table.Size());
+  ASSERT_TRUE(table.Find(0, &frame_id));
+  EXPECT_EQ(3, frame_id);
+  table.Insert(0, 4);
+  EXPECT_EQ(2, table.Size());
+  ASSERT_TRUE(table.Find(0, &frame_id));
+  EXPECT_EQ(4, frame_id);
+  EXPECT_TRUE(table.Erase(0));
+  EXPECT_FALSE(table.Erase(0));
+  EXPECT_FALSE(table.Find(0, &frame_id));
+  ASSERT_TRUE(table.Find(8, &frame_id));
+  EXPECT_EQ(5, frame_id);
+  EXPECT_EQ(1, table.Size());
+}
+
+TEST(PageTableTest, RandomTest) {
+  // Scenario: random inserts and erases agree with std::map, the table is never fuller than its max entries.
+  const size_t max_entries = 100;
+  PageTable table(max_entries);
+  std::map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 1000);
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t page_id = page_dist(gen);
+    if (expected.count(page_id) > 0 || expected.size() == max_entries) {
+      auto victim = expected.count(page_id) > 0 ? expected.find(page_id) : expected.begin();
+      EXPECT_TRUE(table.Erase(victim->first));
+      expected.erase(victim);
+    } else {
+      table.Insert(page_id, i);
+      expected[page_id] = i;
+    }
+  }
+  EXPECT_EQ(expected.size(), table.Size());
+  for (page_id_t page_id = 0; page_id <= 1000; ++page_id) {
+    frame_id_t frame_id;
+    bool found = table.Find(page_id, &frame_id);
+    ASSERT_EQ(expected.count(page_id) > 0, found);
+    if (found) {
+      EXPECT_EQ(expected[page_id], frame_id);
+    }
+  }
+  size_t visited = 0;
+  table.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+    EXPECT_EQ(expected[page_id], frame_id);
+    ++visited;
+  });
+  EXPECT_EQ(expected.size(), visited);
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Scenario: lock-free readers only ever see mappings that were inserted while one writer churns the table. Page p
+  // always maps to frame p % 1000, so any entry a reader finds must agree with that.
+  const page_id_t num_pages = 64;
+  PageTable table(num_pages);
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    table.Insert(page_id, page_id % 1000);
+  }
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+          frame_id_t frame_id;
+          if (table.Find(page_id, &frame_id)) {
+            ASSERT_EQ(page_id % 1000, frame_id);
+          }
+        }
+      }
+    });
+  }
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(16, num_pages - 1);
+  for (int i = 0; i < 200000; ++i) {
+    page_id_t page_id = page_dist(gen);
+    if (!table.Erase(page_id)) {
+      table.Insert(page_id, page_id % 1000);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(table.Find(page_id, &frame_id));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+/**
+ * two_queue_replacer_test.cpp
+ */
+
+#include "buffer/two_queue_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // 8 frames: A1in holds 2 frames, A1out remembers 4 pages
+  TwoQueueReplacer replacer(8);
+
+  // Scenario: frames 0-3 hold pages 100-103, all of them seen once. A1in is [0,1,2,3].
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Get, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  // A second access while a page is still in A1in does not promote it.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: A1in is over its size, so it is evicted from in FIFO order. Pages 100 and 101 go to A1out.
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 comes back into frame 0 and is promoted to Am. Page 200 is new and goes to A1in.
+  // A page from A1out read by a scan is not promoted.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  replacer.RecordAccess(1, AccessType::Get, 200);
+  replacer.RecordAccess(4, AccessType::Scan, 101);
+  replacer.SetEvictable(0, true);
+  replacer.SetEvictable(1, true);
+  replacer.SetEvictable(4, true);
+  ASSERT_EQ(5, replacer.Size());
+
+  // Scenario: A1in is [2,3,1,4] and Am is [0]. A1in goes first until it is back at its size.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: with Am empty, A1in is evicted from even though it is not over its size.
+  replacer.SetEvictable(1, false);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_FALSE(replacer.Evict(&value));
+  ASSERT_EQ(0, replacer.Size());
+
+  // Scenario: removed frames are not remembered, so page 200 starts in A1in again. Page 103 is still in A1out and
+  // goes to Am, which is evicted from first while A1in is not over its size.
+  replacer.SetEvictable(1, true);
+  replacer.Remove(1);
+  replacer.RecordAccess(1, AccessType::Get, 200);
+  replacer.RecordAccess(2, AccessType::Get, 103);
+  replacer.SetEvictable(1, true);
+  replacer.SetEvictable(2, true);
+  ASSERT_EQ(std::vector<frame_id_t>({2, 1}), replacer.Victims(2));
+}
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics_test.cpp
+//
+// Identification: test/common/metrics_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/util/metrics.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MetricsTest, StripedCounterTest) {
+  StripedCounter counter;
+  const int num_threads = 8;
+  const int num_adds = 10000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&counter]() {
+      for (int i = 0; i < num_adds; i++) {
+        counter.Add();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_adds, counter.Load());
+  counter.Add(5);
+  EXPECT_EQ(num_threads * num_adds + 5, counter.Load());
+  counter.Reset();
+  EXPECT_EQ(0, counter.Load());
+}
+
+// NOLINTNEXTLINE
+TEST(MetricsTest, HistogramBucketTest) {
+  // Small values are exact, above that every power of two has SUB_BUCKETS buckets.
+  for (uint64_t v = 0; v < 16; v++) {
+    EXPECT_EQ(v, LatencyHistogram::BucketOf(v));
+  }
+  EXPECT_EQ(LatencyHistogram::BucketOf(16), LatencyHistogram::BucketOf(17));
+  EXPECT_NE(LatencyHistogram::BucketOf(17), LatencyHistogram::BucketOf(18));
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketOf(UINT64_MAX));
+
+  // Buckets cover all values without gaps, and a bucket is at most 1/SUB_BUCKETS of its lower bound wide.
+  for (size_t b = 0; b + 1 < LatencyHistogram::NUM_BUCKETS; b++) {
+    uint64_t lower = LatencyHistogram::BucketLowerBound(b);
+    uint64_t upper = LatencyHistogram::BucketUpperBound(b);
+    ASSERT_EQ(upper + 1, LatencyHistogram::BucketLowerBound(b + 1));
+    ASSERT_EQ(b, LatencyHistogram::BucketOf(lower));
+    ASSERT_EQ(b, LatencyHistogram::BucketOf(upper));
+    ASSERT_LE(upper - lower, lower / LatencyHistogram::SUB_BUCKETS);
+  }
+  EXPECT_EQ(UINT64_MAX, LatencyHistogram::BucketUpperBound(LatencyHistogram::NUM_BUCKETS - 1));
+}
+
+// NOLINTNEXTLINE
+TEST(MetricsTest, HistogramPercentileTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.Snapshot().Percentile(0.5));
+
+  // 1..1000us
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.Record(i * 1000);
+  }
+  auto snapshot = histogram.Snapshot();
+  EXPECT_EQ(1000, snapshot.count_);
+  EXPECT_EQ(1000000, snapshot.max_);
+  EXPECT_DOUBLE_EQ(500500.0, snapshot.Mean());
+  for (double q : {0.5, 0.9, 0.99, 0.999}) {
+    auto exact = static_cast<double>(q * 1000 * 1000);
+    auto estimate = static_cast<double>(snapshot.Percentile(q));
+    EXPECT_GE(estimate, exact);
+    EXPECT_LE(estimate, exact * (1 + 1.0 / LatencyHistogram::SUB_BUCKETS));
+  }
+  EXPECT_EQ(1000000, snapshot.Percentile(1));
+
+  histogram.Reset();
+  snapshot = histogram.Snapshot();
+  EXPECT_EQ(0, snapshot.count_);
+  EXPECT_EQ(0, snapshot.max_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+// check that every page but the root is at least half full and all leaves are at the same depth, return the depth
+auto CheckPage(BufferPoolManager *bpm, page_id_t page_id, bool is_root) -> int {
+  auto guard = bpm->FetchPageRead(page_id);
+  const auto *page = guard.As<BPlusTreePage>();
+  EXPECT_LE(page->GetSize(), page->GetRealMax());
+  if (!is_root) {
+    EXPECT_GE(page->GetSize(), page->GetMinSize());
+  }
+  if (page->IsLeafPage()) {
+    return 1;
+  }
+  const auto *internal_page = guard.As<InternalPage>();
+  int depth = CheckPage(bpm, internal_page->ValueAt(0), false);
+  for (int i = 1; i < internal_page->GetSize(); ++i) {
+    EXPECT_EQ(CheckPage(bpm, internal_page->ValueAt(i), false), depth);
+  }
+  return depth + 1;
+}
+
+// bulk load keys 0, 2, 4, ... with each key given twice, the second time with a different rid that must be skipped
+void BulkLoadAndCheck(int64_t num_keys, double fill_factor) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm.get(), comparator, 6, 5);
+
+  int64_t next = 0;
+  bool duplicate = false;
+  ASSERT_TRUE(tree.BulkLoad(
+      [&](GenericKey<8> *key, RID *rid) {
+        if (next == num_keys) {
+          return false;
+        }
+        key->SetFromInteger(2 * next);
+        *rid = RID(duplicate ? -1 : 2 * next);
+        next += duplicate ? 1 : 0;
+        duplicate = !duplicate;
+        return true;
+      },
+      fill_factor));
+  ASSERT_EQ(tree.IsEmpty(), num_keys == 0);
+  if (num_keys > 0) {
+    CheckPage(bpm.get(), tree.GetRootPageId(), true);
+  }
+
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), expected);
+    ASSERT_EQ((*iter).second, RID(expected));
+    expected += 2;
+  }
+  ASSERT_EQ(expected, 2 * num_keys);
+
+  // the loaded tree takes inserts and removes like any other
+  GenericKey<8> index_key;
+  std::vector<RID> result;
+  for (int64_t key = 1; key < 2 * num_keys; key += 4) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(key)));
+  }
+  for (int64_t key = 0; key < 2 * num_keys; key += 4) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  for (int64_t key = 0; key < 2 * num_keys; ++key) {
+    index_key.SetFromInteger(key);
+    result.clear();
+    ASSERT_EQ(tree.GetValue(index_key, &result), key % 4 == 1 || key % 4 == 2) << key;
+  }
+  // a loaded tree can't be loaded again
+  if (num_keys > 0) {
+    ASSERT_FALSE(tree.BulkLoad([](GenericKey<8> *key, RID *rid) { return false; }));
+  }
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  for (int64_t num_keys : {0, 1, 4, 5, 6, 7, 24, 25, 1000, 4099}) {
+    for (double fill_factor : {1.0, Tree::DEFAULT_FILL_FACTOR, 0.5, 0.01}) {
+      SCOPED_TRACE(testing::Message() << "num_keys=" << num_keys << " fill_factor=" << fill_factor);
+      BulkLoadAndCheck(num_keys, fill_factor);
+    }
+  }
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadFillFactorTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm.get(), comparator, 11, 5);
+
+  int64_t next = 0;
+  tree.BulkLoad(
+      [&](GenericKey<8> *key, RID *rid) {
+        key->SetFromInteger(next);
+        *rid = RID(next);
+        return next++ < 100;
+      },
+      0.8);
+  // leaves hold 10 entries at most, 8 with a fill factor of 0.8
+  auto leaf_guard = bpm->FetchPageRead(tree.GetRootPageId());
+  while (!leaf_guard.As<BPlusTreePage>()->IsLeafPage()) {
+    leaf_guard = bpm->FetchPageRead(leaf_guard.As<InternalPage>()->ValueAt(0));
+  }
+  std::vector<int> sizes;
+  while (true) {
+    sizes.push_back(leaf_guard.As<LeafPage>()->GetSize());
+    page_id_t next_page_id = leaf_guard.As<LeafPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    leaf_guard = bpm->FetchPageRead(next_page_id);
+  }
+  // 100 = 12 * 8 + 4, and 4 is below the minimum of 5, so the last two leaves are evened out
+  std::vector<int> expected(11, 8);
+  expected.push_back(6);
+  expected.push_back(6);
+  ASSERT_EQ(sizes, expected);
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSorterTest) {
+  struct Entry {
+    int32_t key_;
+    int32_t order_;
+  };
+  auto less = [](const Entry &a, const Entry &b) { return a.key_ < b.key_; };
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  // 16 frames merge 4 runs at a time, 100 runs of 1024 entries need three merge passes
+  auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager.get());
+
+  for (size_t num_entries : {static_cast<size_t>(0), static_cast<size_t>(1000), static_cast<size_t>(100 * 1024)}) {
+    std::mt19937 gen(num_entries);
+    std::uniform_int_distribution<int32_t> dist(0, 1000);
+    std::vector<Entry> entries;
+    {
+      ExternalSorter<Entry, decltype(less)> sorter(bpm.get(), less, 1024);
+      for (size_t i = 0; i < num_entries; ++i) {
+        entries.push_back({dist(gen), static_cast<int32_t>(i)});
+        sorter.Add(entries.back());
+      }
+      sorter.Finish();
+      std::stable_sort(entries.begin(), entries.end(), less);
+      Entry entry;
+      for (const auto &expected : entries) {
+        ASSERT_TRUE(sorter.Next(&entry));
+        ASSERT_EQ(entry.key_, expected.key_);
+        ASSERT_EQ(entry.order_, expected.order_);
+      }
+      ASSERT_FALSE(sorter.Next(&entry));
+    }
+    // all temporary pages were unpinned, so the whole pool can be pinned again
+    std::vector<page_id_t> page_ids(16);
+    for (auto &page_id : page_ids) {
+      ASSERT_NE(bpm->NewPage(&page_id), nullptr);
+    }
+    for (auto page_id : page_ids) {
+      bpm->UnpinPage(page_id, false);
+      bpm->DeletePage(page_id);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -129,6 +129,45 @@ void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, con
   delete transaction;
 }
 
+// walk every level of the tree from its leftmost page along the right links, checking that the levels are numbered
+// from the leaves up, that the keys of each page are below its high key and that its right sibling's are not
+void CheckLinks(BufferPoolManager *bpm, page_id_t root_id) {
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  page_id_t leftmost = root_id;
+  int level = bpm->FetchPageRead(root_id).As<BPlusTreePage>()->GetLevel();
+  for (; level >= 0; --level) {
+    bool has_last = false;
+    int64_t last = 0;
+    page_id_t page_id = leftmost;
+    while (page_id != INVALID_PAGE_ID) {
+      auto guard = bpm->FetchPageRead(page_id);
+      const auto *page = guard.As<BPlusTreePage>();
+      ASSERT_EQ(page->GetLevel(), level);
+      ASSERT_EQ(page->IsLeafPage(), level == 0);
+      for (int i = page->IsLeafPage() ? 0 : 1; i < page->GetSize(); ++i) {
+        int64_t key = page->IsLeafPage() ? guard.As<LeafPage>()->KeyAt(i).ToString()
+                                         : guard.As<InternalPage>()->KeyAt(i).ToString();
+        ASSERT_TRUE(!has_last || key > last);
+        has_last = true;
+        last = key;
+      }
+      if (page->GetNextPageId() != INVALID_PAGE_ID) {
+        int64_t high_key = page->IsLeafPage() ? guard.As<LeafPage>()->GetHighKey().ToString()
+                                              : guard.As<InternalPage>()->GetHighKey().ToString();
+        ASSERT_TRUE(!has_last || last < high_key);
+        // the separators of the next page, and the keys below them, start at the high key
+        has_last = true;
+        last = high_key - 1;
+      }
+      if (page_id == leftmost && !page->IsLeafPage()) {
+        leftmost = guard.As<InternalPage>()->ValueAt(0);
+      }
+      page_id = page->GetNextPageId();
+    }
+  }
+}
+
 TEST(BPlusTreeConcurrentTest, talps_concurrent_insert1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
@@ -619,4 +658,189 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, SwizzledMixTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // the pool is too small for the tree, so children are evicted and swips go stale
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree in swizzled mode, small nodes so that splits and merges move child pointers around
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 5, true);
+
+  std::vector<int64_t> keys;
+  int64_t total_keys = 1000;
+  for (int64_t key = 1; key <= total_keys; key++) {
+    keys.push_back(key);
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+  LaunchParallelTest(4, LookupHelper, &tree, keys, 1);
+
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> remaining_keys;
+  for (auto key : keys) {
+    (key % 3 == 0 ? remaining_keys : remove_keys).push_back(key);
+  }
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+  LaunchParallelTest(4, LookupHelper, &tree, remaining_keys, 1);
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : remove_keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_FALSE(tree.GetValue(index_key, &rids));
+  }
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    size++;
+  }
+  ASSERT_EQ(size, remaining_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticMixTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // most inserts and removes only change their leaf and take the optimistic path, every few of them splits or
+  // underflows a leaf and restarts pessimistically while the others keep going
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 8, 5);
+
+  std::vector<int64_t> old_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    (key % 2 == 0 ? old_keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, old_keys);
+
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> remaining_keys;
+  for (auto key : old_keys) {
+    (key % 4 == 0 ? remove_keys : remaining_keys).push_back(key);
+  }
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < 3; tid++) {
+    threads.emplace_back(InsertHelperSplit, &tree, new_keys, 3, tid);
+    threads.emplace_back(DeleteHelperSplit, &tree, remove_keys, 3, tid);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  remaining_keys.insert(remaining_keys.end(), new_keys.begin(), new_keys.end());
+  std::sort(remaining_keys.begin(), remaining_keys.end());
+
+  // the leaves still hold exactly the remaining keys, in order
+  std::vector<int64_t> scanned;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    scanned.push_back((*iter).first.ToString());
+  }
+  ASSERT_EQ(scanned, remaining_keys);
+  LookupHelper(&tree, remaining_keys, 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, BLinkTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small nodes split all the time, so readers keep running into splits whose separator isn't posted yet
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 5);
+
+  std::vector<int64_t> old_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    (key % 2 == 0 ? old_keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, old_keys);
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < 4; tid++) {
+    threads.emplace_back(InsertHelperSplit, &tree, new_keys, 4, tid);
+  }
+  for (uint64_t tid = 0; tid < 2; tid++) {
+    threads.emplace_back(LookupHelper, &tree, old_keys, tid, 0);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  CheckLinks(bpm, tree.GetRootPageId());
+
+  // removes merge and borrow around the links, while readers still look up the keys that stay
+  std::vector<int64_t> all_keys(old_keys);
+  all_keys.insert(all_keys.end(), new_keys.begin(), new_keys.end());
+  std::sort(all_keys.begin(), all_keys.end());
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> remaining_keys;
+  for (auto key : all_keys) {
+    (key % 3 == 0 ? remaining_keys : remove_keys).push_back(key);
+  }
+  threads.clear();
+  for (uint64_t tid = 0; tid < 4; tid++) {
+    threads.emplace_back(DeleteHelperSplit, &tree, remove_keys, 4, tid);
+  }
+  for (uint64_t tid = 0; tid < 2; tid++) {
+    threads.emplace_back(LookupHelper, &tree, remaining_keys, tid, 0);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  CheckLinks(bpm, tree.GetRootPageId());
+  std::vector<int64_t> scanned;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    scanned.push_back((*iter).first.ToString());
+  }
+  ASSERT_EQ(scanned, remaining_keys);
+
+  // a bulk loaded tree is linked the same way
+  page_id_t bulk_header_id;
+  bpm->NewPage(&bulk_header_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> bulk_tree("bulk_pk", bulk_header_id, bpm, comparator, 3, 5);
+  size_t next = 0;
+  ASSERT_TRUE(bulk_tree.BulkLoad(
+      [&](GenericKey<8> *key, RID *rid) {
+        if (next == all_keys.size()) {
+          return false;
+        }
+        key->SetFromInteger(all_keys[next]);
+        rid->Set(0, static_cast<uint32_t>(all_keys[next]));
+        ++next;
+        return true;
+      },
+      1.0));
+  CheckLinks(bpm, bulk_tree.GetRootPageId());
+  LookupHelper(&bulk_tree, all_keys, 1);
+
+  bpm->UnpinPage(bulk_header_id, true);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
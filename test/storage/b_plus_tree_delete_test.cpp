@@ -502,4 +502,52 @@ TEST(BPlusTreeTests, talps_delete2) {
   }
 }
 
+TEST(BPlusTreeTests, DeleteReclaimsPagesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator,
+                                                           4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  auto transaction = std::make_unique<Transaction>(0);
+
+  const int64_t scale = 2000;
+  auto insert_all = [&]() {
+    for (int64_t key = 0; key < scale; key++) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction.get());
+    }
+  };
+  insert_all();
+  auto num_pages = disk_manager->GetNumPages();
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: pages merged away are returned to the disk manager, down to the last leaf.
+  for (int64_t key = 0; key < scale; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction.get());
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(num_pages - 1, disk_manager->GetNumFreePages());
+
+  // Scenario: the tree is rebuilt from the freed pages, the file does not grow.
+  insert_all();
+  EXPECT_EQ(num_pages, disk_manager->GetNumPages());
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
 }  // namespace bustub
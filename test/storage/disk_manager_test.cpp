@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
 #include <cstring>
+#include <mutex>   // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_compressed.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_manager_uring.h"
+#include "storage/disk/page_codec.h"
 
 namespace bustub {
 
@@ -24,12 +34,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cmap");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cmap");
   };
 };
 
@@ -72,6 +86,323 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixReadWritePageTest) {
+  for (bool direct_io : {false, true}) {
+    remove("test.db");
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    char data[BUSTUB_PAGE_SIZE] = {0};
+    std::string db_file("test.db");
+    auto dm = DiskManagerPosix(db_file, direct_io);
+    std::strncpy(data, "A test string.", sizeof(data));
+
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(0, buf);  // empty read yields a zeroed page
+    EXPECT_EQ(buf[0], 0);
+    EXPECT_EQ(buf[BUSTUB_PAGE_SIZE - 1], 0);
+
+    dm.WritePage(0, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+    // pages 1..4 form a hole in the file
+    std::memset(buf, 0, sizeof(buf));
+    dm.WritePage(5, data);
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(buf[0], 0);
+
+    std::vector<char> pages(3 * BUSTUB_PAGE_SIZE);
+    for (size_t i = 0; i < 3; i++) {
+      pages[i * BUSTUB_PAGE_SIZE] = static_cast<char>('a' + i);
+    }
+    dm.WritePages(7, pages.data(), 3);
+    for (size_t i = 0; i < 3; i++) {
+      dm.ReadPage(7 + i, buf);
+      EXPECT_EQ(buf[0], static_cast<char>('a' + i));
+    }
+    EXPECT_EQ(dm.GetNumWrites(), 5);
+    dm.Sync();
+    dm.ShutDown();
+
+    // the data is still there after reopening
+    auto dm2 = DiskManagerPosix(db_file, direct_io);
+    dm2.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm2.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixConcurrentWriteTest) {
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 64;
+  auto dm = DiskManagerPosix("test.db");
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        auto page_id = static_cast<page_id_t>(i * num_threads + t);
+        std::memcpy(data, &page_id, sizeof(page_id));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(dm.GetNumWrites(), num_threads * pages_per_thread);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, UringExecuteBatchTest) {
+  const size_t num_pages = 200;  // more than the queue depth
+
+  for (bool use_io_uring : {true, false}) {
+    remove("test.db");
+    auto dm = DiskManagerUring("test.db", false, use_io_uring, 32);
+    EXPECT_EQ(dm.GetMaxBatchSize(), 32);
+
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::vector<DiskIO> ios;
+    for (size_t i = 0; i < num_pages; i++) {
+      snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+      ios.push_back({true, static_cast<page_id_t>(i), data[i].data()});
+    }
+    std::vector<int> completed(num_pages, 0);
+    std::mutex latch;
+    auto on_complete = [&](size_t idx, const std::exception_ptr &error) {
+      std::scoped_lock lk(latch);
+      EXPECT_EQ(error, nullptr);
+      completed[idx]++;
+    };
+    dm.ExecuteBatch(ios, on_complete);
+    EXPECT_EQ(dm.GetNumWrites(), num_pages);
+
+    std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+    ios.clear();
+    for (size_t i = 0; i < num_pages; i++) {
+      ios.push_back({false, static_cast<page_id_t>(i), bufs[i].data()});
+    }
+    dm.ExecuteBatch(ios, on_complete);
+    for (size_t i = 0; i < num_pages; i++) {
+      EXPECT_EQ(completed[i], 2);
+      EXPECT_EQ(std::memcmp(bufs[i].data(), data[i].data(), BUSTUB_PAGE_SIZE), 0);
+    }
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadOnlyTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto dm = DiskManager(db_file);
+  dm.WritePage(0, data);
+  dm.WritePage(3, data);
+  dm.ShutDown();
+
+  auto mmap_dm = DiskManagerMmap(db_file);
+  EXPECT_EQ(mmap_dm.GetMappedSize(), 4 * BUSTUB_PAGE_SIZE);
+  mmap_dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  mmap_dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(std::memcmp(mmap_dm.GetPagePointer(3), data, sizeof(data)), 0);
+
+  // holes and pages past the end of the snapshot read as zeros
+  mmap_dm.ReadPage(1, buf);
+  EXPECT_EQ(buf[0], 0);
+  std::memset(buf, 1, sizeof(buf));
+  mmap_dm.ReadPage(10, buf);
+  EXPECT_EQ(buf[0], 0);
+  EXPECT_EQ(mmap_dm.GetPagePointer(10), nullptr);
+
+  EXPECT_THROW(mmap_dm.WritePage(0, data), Exception);
+  mmap_dm.ShutDown();
+
+  EXPECT_THROW(DiskManagerMmap("dev/null\\/foo/bar/baz/test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: a new file grows page by page.
+  for (page_id_t i = 0; i < 8; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+    dm.WritePage(i, data);
+  }
+  EXPECT_EQ(8, dm.GetNumPages());
+  EXPECT_EQ(0, dm.GetNumFreePages());
+
+  // Scenario: freed pages are reused, lowest page id first.
+  dm.DeallocatePage(5);
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(100);
+  EXPECT_EQ(2, dm.GetNumFreePages());
+  EXPECT_FALSE(dm.IsAllocated(2));
+  EXPECT_TRUE(dm.IsAllocated(3));
+  EXPECT_EQ(2, dm.AllocatePage());
+  EXPECT_EQ(5, dm.AllocatePage());
+  EXPECT_EQ(8, dm.AllocatePage());
+
+  // Scenario: partitions only get their own page ids; ids skipped on the way are free for the other partitions.
+  EXPECT_EQ(10, dm.AllocatePage(3, 1));
+  EXPECT_EQ(11, dm.GetNumPages());
+  EXPECT_EQ(1, dm.GetNumFreePages());
+  EXPECT_EQ(9, dm.AllocatePage(3, 0));
+  EXPECT_EQ(11, dm.AllocatePage(3, 2));
+  EXPECT_EQ(12, dm.AllocatePage(3, 0));
+  dm.WritePage(12, data);
+
+  // Scenario: the map survives a restart.
+  dm.DeallocatePage(1);
+  dm.DeallocatePage(11);
+  dm.DeallocatePage(12);
+  dm.ShutDown();
+  auto reopened = DiskManager(db_file);
+  EXPECT_EQ(13, reopened.GetNumPages());
+  EXPECT_EQ(3, reopened.GetNumFreePages());
+  EXPECT_FALSE(reopened.IsAllocated(1));
+  EXPECT_TRUE(reopened.IsAllocated(10));
+
+  // Scenario: shrinking cuts the free pages at the end of the file off.
+  EXPECT_EQ(2, reopened.Shrink());
+  EXPECT_EQ(11, reopened.GetNumPages());
+  struct stat st {};
+  ASSERT_EQ(0, stat(db_file.c_str(), &st));
+  EXPECT_EQ(11 * BUSTUB_PAGE_SIZE, st.st_size);
+  EXPECT_EQ(1, reopened.GetNumFreePages());
+  EXPECT_EQ(0, reopened.Shrink());
+  EXPECT_EQ(1, reopened.AllocatePage());
+  EXPECT_EQ(11, reopened.AllocatePage());
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageCodecTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char compressed[BUSTUB_PAGE_SIZE];
+  char buf[BUSTUB_PAGE_SIZE];
+
+  // Scenario: a zeroed page is a single run.
+  size_t size = PageCodec::Compress(data, BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE);
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, 32);
+  ASSERT_TRUE(PageCodec::Decompress(compressed, size, buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+
+  // Scenario: small integers followed by a zeroed tail, like a table page.
+  for (int i = 0; i < 256; i++) {
+    auto value = static_cast<int32_t>(i % 7);
+    memcpy(data + i * sizeof(int32_t), &value, sizeof(int32_t));
+  }
+  size = PageCodec::Compress(data, BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE);
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, BUSTUB_PAGE_SIZE / 8);
+  ASSERT_TRUE(PageCodec::Decompress(compressed, size, buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+
+  // Scenario: truncated or corrupted input is rejected instead of overrunning the output.
+  EXPECT_FALSE(PageCodec::Decompress(compressed, size / 2, buf, BUSTUB_PAGE_SIZE));
+  EXPECT_FALSE(PageCodec::Decompress(compressed, size, buf, BUSTUB_PAGE_SIZE - 1));
+
+  // Scenario: random data does not fit into less than a page, but round-trips with room to expand.
+  std::mt19937 gen(42);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_EQ(0, PageCodec::Compress(data, BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE - 1));
+  std::vector<char> large(2 * BUSTUB_PAGE_SIZE);
+  size = PageCodec::Compress(data, BUSTUB_PAGE_SIZE, large.data(), large.size());
+  ASSERT_NE(0, size);
+  ASSERT_TRUE(PageCodec::Decompress(large.data(), size, buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressedReadWriteTest) {
+  const page_id_t num_pages = 64;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManagerCompressed(db_file);
+
+  // Scenario: mostly-zero pages take a fraction of their size.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, dm.AllocatePage());
+    snprintf(data, sizeof(data), "page %d", i);
+    dm.WritePage(i, data);
+  }
+  for (page_id_t i = 0; i < num_pages; i++) {
+    snprintf(data, sizeof(data), "page %d", i);
+    dm.ReadPage(i, buf);
+    EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+  }
+  EXPECT_GT(dm.GetCompressionRatio(), 50);
+  EXPECT_EQ(num_pages * DiskManagerCompressed::SLOT_ALIGNMENT, dm.GetFileBytes());
+
+  // Scenario: a page that grows moves out of its slot, its old slot is reused by the next page that fits.
+  std::mt19937 gen(42);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  dm.WritePage(3, data);
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(num_pages * DiskManagerCompressed::SLOT_ALIGNMENT + BUSTUB_PAGE_SIZE, dm.GetFileBytes());
+  memset(data, 0, sizeof(data));
+  ASSERT_EQ(num_pages, dm.AllocatePage());
+  dm.WritePage(num_pages, data);
+  EXPECT_EQ(num_pages * DiskManagerCompressed::SLOT_ALIGNMENT + BUSTUB_PAGE_SIZE, dm.GetFileBytes());
+
+  // Scenario: deallocated pages give their slot back.
+  size_t stored_bytes = dm.GetStoredBytes();
+  dm.DeallocatePage(5);
+  EXPECT_LT(dm.GetStoredBytes(), stored_bytes);
+
+  // Scenario: the slot map survives a restart.
+  dm.ShutDown();
+  auto reopened = DiskManagerCompressed(db_file);
+  EXPECT_EQ(num_pages + 1, reopened.GetNumPages());
+  EXPECT_FALSE(reopened.IsAllocated(5));
+  for (page_id_t i = 0; i < num_pages; i++) {
+    if (i == 3 || i == 5) {
+      continue;
+    }
+    snprintf(data, sizeof(data), "page %d", i);
+    reopened.ReadPage(i, buf);
+    EXPECT_EQ(0, memcmp(buf, data, BUSTUB_PAGE_SIZE));
+  }
+  reopened.ReadPage(5, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: shrinking frees the slots of the pages cut off.
+  reopened.DeallocatePage(num_pages);
+  reopened.DeallocatePage(num_pages - 1);
+  EXPECT_EQ(2, reopened.Shrink());
+  EXPECT_EQ(num_pages - 1, reopened.GetNumPages());
+  reopened.ShutDown();
+
+  // A database file without its slot map can't be opened.
+  remove("test.cmap");
+  EXPECT_THROW(DiskManagerCompressed{db_file}, Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
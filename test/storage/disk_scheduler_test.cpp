@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_uring.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+
+  disk_scheduler->Schedule({/*is_write=*/true, data, /*page_id=*/0, std::move(promise1)});
+  ASSERT_TRUE(future1.get());
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/0, std::move(promise2)});
+  ASSERT_TRUE(future2.get());
+
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  disk_scheduler = nullptr;  // Call the DiskScheduler destructor to finish all scheduled jobs.
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ConcurrentRequestsTest) {
+  const size_t num_pages = 64;
+  const size_t num_workers = 4;
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  dm->SetLatency(1);
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), num_workers);
+  ASSERT_EQ(num_workers, disk_scheduler->GetNumWorkers());
+
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> writes;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    writes.emplace_back(disk_scheduler->ScheduleWrite(static_cast<page_id_t>(i), data[i].data()));
+  }
+  for (auto &write : writes) {
+    ASSERT_TRUE(write.get());
+  }
+
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> reads;
+  for (size_t i = 0; i < num_pages; i++) {
+    reads.emplace_back(disk_scheduler->ScheduleRead(static_cast<page_id_t>(i), bufs[i].data()));
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(reads[i].get());
+    ASSERT_EQ(std::memcmp(bufs[i].data(), data[i].data(), BUSTUB_PAGE_SIZE), 0);
+  }
+
+  disk_scheduler = nullptr;
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, BatchedUringTest) {
+  const size_t num_pages = 256;
+
+  for (bool use_io_uring : {true, false}) {
+    remove("test_uring.db");
+    remove("test_uring.log");
+    auto dm = std::make_unique<DiskManagerUring>("test_uring.db", false, use_io_uring);
+    // a single worker has to keep the whole queue depth in flight
+    auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), 1);
+
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::vector<std::future<bool>> writes;
+    for (size_t i = 0; i < num_pages; i++) {
+      snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+      writes.emplace_back(disk_scheduler->ScheduleWrite(static_cast<page_id_t>(i), data[i].data()));
+    }
+    for (auto &write : writes) {
+      ASSERT_TRUE(write.get());
+    }
+    ASSERT_EQ(dm->GetNumWrites(), num_pages);
+
+    std::vector<std::vector<char>> bufs(num_pages + 1, std::vector<char>(BUSTUB_PAGE_SIZE, 1));
+    std::vector<std::future<bool>> reads;
+    for (size_t i = 0; i <= num_pages; i++) {
+      reads.emplace_back(disk_scheduler->ScheduleRead(static_cast<page_id_t>(i), bufs[i].data()));
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      ASSERT_TRUE(reads[i].get());
+      ASSERT_EQ(std::memcmp(bufs[i].data(), data[i].data(), BUSTUB_PAGE_SIZE), 0);
+    }
+    // reading past the end of the file yields a zeroed page
+    ASSERT_TRUE(reads[num_pages].get());
+    ASSERT_EQ(bufs[num_pages][0], 0);
+
+    disk_scheduler = nullptr;
+    dm->ShutDown();
+  }
+  remove("test_uring.db");
+  remove("test_uring.log");
+}
+
+}  // namespace bustub
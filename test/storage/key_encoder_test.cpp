@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder_test.cpp
+//
+// Identification: test/storage/key_encoder_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/key_encoder.h"
+#include "storage/table/tuple.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// encode every value on its own, the keys must compare like the values, which are given in ascending order
+void CheckOrdered(const std::vector<Value> &values) {
+  GenericComparator<32> comparator(nullptr);
+  std::vector<GenericKey<32>> keys(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    std::vector<char> data;
+    KeyEncoder::Encode(values[i], &data);
+    ASSERT_LE(data.size(), 32);
+    memset(keys[i].data_, 0, 32);
+    memcpy(keys[i].data_, data.data(), data.size());
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (size_t j = 0; j < keys.size(); ++j) {
+      int expected = i < j ? -1 : (i == j ? 0 : 1);
+      ASSERT_EQ(comparator(keys[i], keys[j]), expected) << values[i].ToString() << " vs " << values[j].ToString();
+    }
+  }
+}
+
+TEST(KeyEncoderTest, OrderTest) {
+  CheckOrdered({ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetIntegerValue(-1000000),
+                ValueFactory::GetIntegerValue(-1), ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(1),
+                ValueFactory::GetIntegerValue(256), ValueFactory::GetIntegerValue(std::numeric_limits<int32_t>::max())});
+  CheckOrdered({ValueFactory::GetNullValueByType(TypeId::BIGINT), ValueFactory::GetBigIntValue(-(INT64_C(1) << 40)),
+                ValueFactory::GetBigIntValue(-1), ValueFactory::GetBigIntValue(0), ValueFactory::GetBigIntValue(255),
+                ValueFactory::GetBigIntValue(INT64_C(1) << 40)});
+  CheckOrdered({ValueFactory::GetNullValueByType(TypeId::DECIMAL), ValueFactory::GetDecimalValue(-1e10),
+                ValueFactory::GetDecimalValue(-1.5), ValueFactory::GetDecimalValue(-0.25),
+                ValueFactory::GetDecimalValue(0), ValueFactory::GetDecimalValue(0.25), ValueFactory::GetDecimalValue(1.5),
+                ValueFactory::GetDecimalValue(1e10)});
+  CheckOrdered({ValueFactory::GetTimestampValue(static_cast<int64_t>(BUSTUB_TIMESTAMP_NULL)), ValueFactory::GetTimestampValue(0),
+                ValueFactory::GetTimestampValue(1), ValueFactory::GetTimestampValue(INT64_C(1) << 40)});
+  CheckOrdered({ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetVarcharValue(""),
+                ValueFactory::GetVarcharValue("a"), ValueFactory::GetVarcharValue(std::string("a\0", 2)),
+                ValueFactory::GetVarcharValue(std::string("a\0b", 3)), ValueFactory::GetVarcharValue("ab"),
+                ValueFactory::GetVarcharValue("b"), ValueFactory::GetVarcharValue("\xff")});
+}
+
+TEST(KeyEncoderTest, KeyFromTupleTest) {
+  Schema schema({Column("a", TypeId::VARCHAR, 16), Column("b", TypeId::INTEGER), Column("c", TypeId::BIGINT)});
+  std::vector<uint32_t> key_attrs{0, 2};
+  Schema key_schema = Schema::CopySchema(&schema, key_attrs);
+  GenericComparator<32> comparator(&key_schema);
+
+  // keys (a, c) in ascending order, a shorter varchar must not compare by the bytes of the column after it
+  std::vector<std::pair<std::string, int64_t>> rows{{"", 5}, {"a", -3}, {"a", 7}, {"ab", -100}, {"b", 0}};
+  std::vector<GenericKey<32>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    Tuple tuple({ValueFactory::GetVarcharValue(rows[i].first), ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                 ValueFactory::GetBigIntValue(rows[i].second)},
+                &schema);
+    keys[i].SetFromKey(tuple.KeyFromTuple(schema, key_schema, key_attrs));
+  }
+  for (size_t i = 0; i + 1 < keys.size(); ++i) {
+    ASSERT_EQ(comparator(keys[i], keys[i + 1]), -1) << i;
+    ASSERT_EQ(comparator(keys[i + 1], keys[i]), 1) << i;
+    ASSERT_EQ(comparator(keys[i], keys[i]), 0) << i;
+  }
+
+  // a key that doesn't fit the index is rejected instead of cut off
+  Schema long_schema({Column("a", TypeId::VARCHAR, 64), Column("b", TypeId::INTEGER), Column("c", TypeId::BIGINT)});
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(40, 'x')), ValueFactory::GetIntegerValue(0),
+               ValueFactory::GetBigIntValue(0)},
+              &long_schema);
+  GenericKey<32> key;
+  ASSERT_THROW(key.SetFromKey(tuple.KeyFromTuple(long_schema, key_schema, key_attrs)), Exception);
+
+  // the integer keys of the tests round trip
+  GenericKey<8> int_key;
+  for (int64_t v : {std::numeric_limits<int64_t>::min(), INT64_C(-1), INT64_C(0), INT64_C(42)}) {
+    int_key.SetFromInteger(v);
+    ASSERT_EQ(int_key.ToString(), v);
+  }
+}
+
+TEST(KeyEncoderTest, MaxSizeTest) {
+  Schema schema({Column("a", TypeId::VARCHAR, 10), Column("b", TypeId::INTEGER), Column("c", TypeId::BIGINT)});
+  ASSERT_EQ(KeyEncoder::MaxSize(Schema::CopySchema(&schema, {1})), 4);
+  ASSERT_EQ(KeyEncoder::MaxSize(Schema::CopySchema(&schema, {1, 2})), 12);
+
+  // the key of the longest varchar is exactly as long as the max size
+  std::vector<uint32_t> key_attrs{0, 1};
+  Schema key_schema = Schema::CopySchema(&schema, key_attrs);
+  ASSERT_EQ(KeyEncoder::MaxSize(key_schema), 17);
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(10, 'x')), ValueFactory::GetIntegerValue(1),
+               ValueFactory::GetBigIntValue(2)},
+              &schema);
+  ASSERT_EQ(tuple.KeyFromTuple(schema, key_schema, key_attrs).GetLength(), 17);
+}
+
+}  // namespace bustub
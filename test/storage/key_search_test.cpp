@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_test.cpp
+//
+// Identification: test/storage/key_search_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_encoder.h"
+#include "storage/index/key_search.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+template <size_t KeySize>
+auto MakeKey(int64_t v) -> GenericKey<KeySize> {
+  GenericKey<KeySize> key;
+  std::vector<char> data;
+  if constexpr (KeySize == 4) {
+    KeyEncoder::Encode(ValueFactory::GetIntegerValue(static_cast<int32_t>(v)), &data);
+  } else {
+    KeyEncoder::Encode(ValueFactory::GetBigIntValue(v), &data);
+  }
+  memset(key.data_, 0, KeySize);
+  memcpy(key.data_, data.data(), data.size());
+  return key;
+}
+
+// compare the search with every instruction set the CPU has against a plain search of the same keys
+template <size_t KeySize>
+void CheckSearch() {
+  auto original = KeySearch::GetIsa();
+  GenericComparator<KeySize> comparator(nullptr);
+  std::mt19937 gen(KeySize);
+  std::uniform_int_distribution<int64_t> dist(-1000, 1000);
+  for (int n : {0, 1, 2, 3, 5, 8, 15, 16, 17, 31, 64, 255, 500}) {
+    std::vector<int64_t> values(n);
+    for (auto &v : values) {
+      v = dist(gen);
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    std::vector<GenericKey<KeySize>> keys;
+    for (auto v : values) {
+      keys.push_back(MakeKey<KeySize>(v));
+    }
+    int size = static_cast<int>(keys.size());
+    for (auto isa : {KeySearch::Isa::SCALAR, KeySearch::Isa::SSE42, KeySearch::Isa::AVX2}) {
+      if (!KeySearch::Use(isa)) {
+        continue;
+      }
+      for (int64_t v = -1002; v <= 1002; v += 1) {
+        auto key = MakeKey<KeySize>(v);
+        int lower = std::lower_bound(values.begin(), values.end(), v) - values.begin();
+        int upper = std::upper_bound(values.begin(), values.end(), v) - values.begin();
+        ASSERT_EQ(KeySearch::Search(keys.data(), 0, size, key, comparator, false), lower) << n << " " << v;
+        ASSERT_EQ(KeySearch::Search(keys.data(), 0, size, key, comparator, true), upper) << n << " " << v;
+        if (size > 1) {
+          ASSERT_EQ(KeySearch::Search(keys.data(), 1, size, key, comparator, true), std::max(upper, 1));
+        }
+      }
+    }
+  }
+  KeySearch::Use(original);
+}
+
+TEST(KeySearchTest, SearchTest) {
+  CheckSearch<4>();
+  CheckSearch<8>();
+  CheckSearch<16>();
+}
+
+TEST(KeySearchTest, TreeTest) {
+  auto original = KeySearch::GetIsa();
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  for (auto isa : {KeySearch::Isa::SCALAR, KeySearch::Isa::SSE42, KeySearch::Isa::AVX2}) {
+    if (!KeySearch::Use(isa)) {
+      continue;
+    }
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator);
+
+    std::vector<int64_t> keys(20000);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = 3 * static_cast<int64_t>(i) - 30000;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, RID(key)));
+    }
+    std::vector<RID> result;
+    for (int64_t key = -30001; key < 30001; ++key) {
+      index_key.SetFromInteger(key);
+      result.clear();
+      bool present = key % 3 == 0 && key < 30000;
+      ASSERT_EQ(tree.GetValue(index_key, &result), present) << key;
+      if (present) {
+        ASSERT_EQ(result[0], RID(key));
+      }
+    }
+    int64_t expected = -30000;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      ASSERT_EQ((*iter).first.ToString(), expected);
+      expected += 3;
+    }
+    ASSERT_EQ(expected, 30000);
+  }
+  KeySearch::Use(original);
+}
+
+}  // namespace bustub
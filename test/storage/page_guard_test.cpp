@@ -86,5 +86,52 @@ TEST(PageGuardTest, ReadTset) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
 }
+
+TEST(PageGuardTest, OptimisticReadTest) {
+  const size_t buffer_pool_size = 1;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "hello");
+  }
+
+  // an optimistic read neither pins nor latches the page, and stays valid until the page is written to
+  auto optimistic = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(page_id, optimistic.PageId());
+  EXPECT_STREQ("hello", optimistic.As<char>());
+  EXPECT_EQ(0, bpm->GetPages()[0].GetPinCount());
+  EXPECT_TRUE(optimistic.Validate());
+  {
+    auto read_guard = bpm->FetchPageRead(page_id);
+    EXPECT_TRUE(optimistic.Validate());
+  }
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_FALSE(optimistic.Validate());
+    snprintf(write_guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "world");
+  }
+  EXPECT_FALSE(optimistic.Validate());
+
+  optimistic = bpm->FetchPageOptimistic(page_id);
+  EXPECT_STREQ("world", optimistic.As<char>());
+  EXPECT_TRUE(optimistic.Validate());
+
+  // evicting the page invalidates the guard, fetching it again reads it back in
+  page_id_t other_page_id;
+  bpm->NewPageGuarded(&other_page_id);
+  EXPECT_FALSE(optimistic.Validate());
+  optimistic = bpm->FetchPageOptimistic(page_id);
+  EXPECT_STREQ("world", optimistic.As<char>());
+  EXPECT_TRUE(optimistic.Validate());
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
 //
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <fstream>
 #include <iostream>
 
 #include "buffer/buffer_pool_manager.h"
@@ -116,7 +117,10 @@ auto main(int argc, char **argv) -> int {
         break;
       case 'g':
         std::cin >> filename;
-        tree.Draw(bpm, filename);
+        {
+          std::ofstream out(filename);
+          tree.Draw(bpm, out);
+        }
         break;
       case '?':
         std::cout << UsageMessage();
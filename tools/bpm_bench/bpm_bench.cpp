@@ -1,4 +1,5 @@
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -13,13 +14,17 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
 #include "fmt/core.h"
 #include "fmt/std.h"
+#include "storage/disk/disk_manager_compressed.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_manager_uring.h"
 
 #include <sys/time.h>
 
@@ -34,10 +39,17 @@ static const size_t BUSTUB_GET_THREAD = 8;
 static const size_t LRU_K_SIZE = 16;
 static const size_t BUSTUB_PAGE_CNT = 6400;
 static const size_t BUSTUB_BPM_SIZE = 64;
+static const char *BUSTUB_BENCH_DB_FILE = "bpm_bench.db";
 
 struct BpmTotalMetrics {
+  std::string replacer_;
   uint64_t scan_cnt_{0};
   uint64_t get_cnt_{0};
+  uint64_t get_miss_cnt_{0};
+  uint64_t flushed_pages_{0};
+  uint64_t dirty_victims_{0};
+  uint64_t misses_{0};
+  uint64_t fetch_miss_p99_ns_{0};
   uint64_t start_time_{0};
   std::mutex mutex_;
 
@@ -48,20 +60,33 @@ struct BpmTotalMetrics {
     scan_cnt_ += scan_cnt;
   }
 
-  void ReportGet(uint64_t get_cnt) {
+  void ReportGet(uint64_t get_cnt, uint64_t get_miss_cnt) {
     std::unique_lock<std::mutex> l(mutex_);
     get_cnt_ += get_cnt;
+    get_miss_cnt_ += get_miss_cnt;
   }
 
-  void Report() {
+  void Report(bool report_hit_rate) {
     auto now = ClockMs();
     auto elsped = now - start_time_;
     auto scan_per_sec = scan_cnt_ / static_cast<double>(elsped) * 1000;
     auto get_per_sec = get_cnt_ / static_cast<double>(elsped) * 1000;
 
     fmt::print("<<< BEGIN\n");
+    fmt::print("replacer: {}\n", replacer_);
     fmt::print("scan: {}\n", scan_per_sec);
     fmt::print("get: {}\n", get_per_sec);
+    fmt::print("flushed_pages: {}\n", flushed_pages_ / static_cast<double>(elsped) * 1000);
+    fmt::print("dirty_victims: {}\n", dirty_victims_);
+    if (scan_cnt_ + get_cnt_ > 0) {
+      fmt::print("hit_rate: {}\n", 1 - misses_ / static_cast<double>(scan_cnt_ + get_cnt_));
+    }
+    if (misses_ > 0) {
+      fmt::print("fetch_miss_p99_us: {}\n", fetch_miss_p99_ns_ / 1000.0);
+    }
+    if (report_hit_rate && get_cnt_ > 0) {
+      fmt::print("get_hit_rate: {}\n", 1 - get_miss_cnt_ / static_cast<double>(get_cnt_));
+    }
     fmt::print(">>> END\n");
   }
 };
@@ -104,12 +129,45 @@ struct BpmMetrics {
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
+  using bustub::DiskManager;
+  using bustub::DiskManagerCompressed;
+  using bustub::DiskManagerMmap;
+  using bustub::DiskManagerPosix;
   using bustub::DiskManagerUnlimitedMemory;
+  using bustub::DiskManagerUring;
   using bustub::page_id_t;
+  using bustub::ReplacerPolicy;
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
-  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--latency").help("set disk latency to n milliseconds, only for the memory disk");
+  program.add_argument("--disk")
+      .help("disk manager: memory, fstream, posix, uring, mmap or compressed. All but memory use " +
+            std::string(BUSTUB_BENCH_DB_FILE))
+      .default_value(std::string("memory"));
+  program.add_argument("--huge-pages")
+      .help("back the frame arena with huge pages")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--read-only")
+      .help("scan threads read pages instead of updating them, implied by --disk mmap")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--scan-thread-n").help("run n scan threads");
+  program.add_argument("--get-thread-n").help("run n get threads");
+  program.add_argument("--shards").help("split the buffer pool into n shards");
+  program.add_argument("--flush-thread")
+      .help("clean dirty pages in the background")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--replacer")
+      .help("replacement policy: lru-k, lru, clock, 2q or arc. A comma-separated list or all runs the benchmark once "
+            "per policy")
+      .default_value(std::string("lru-k"));
+  program.add_argument("--no-scan-hint")
+      .help("fetch pages of scan threads as AccessType::Unknown instead of AccessType::Scan")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,104 +187,229 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
-  std::vector<page_id_t> page_ids;
-
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
-
-  for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
-    page_id_t page_id;
-    auto *page = bpm->NewPage(&page_id);
-    if (page == nullptr) {
-      throw std::runtime_error("new page failed");
-    }
-    char &ch = page->GetData()[i % 1024];
-    ch = 1;
-
-    bpm->UnpinPage(page_id, true);
-    page_ids.push_back(page_id);
+  size_t scan_thread_n = BUSTUB_SCAN_THREAD;
+  if (program.present("--scan-thread-n")) {
+    scan_thread_n = std::stoi(program.get("--scan-thread-n"));
   }
 
-  // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
-
-  fmt::print(stderr, "[info] benchmark start\n");
-
-  BpmTotalMetrics total_metrics;
-  total_metrics.Begin();
-
-  std::vector<std::thread> threads;
+  size_t get_thread_n = BUSTUB_GET_THREAD;
+  if (program.present("--get-thread-n")) {
+    get_thread_n = std::stoi(program.get("--get-thread-n"));
+  }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
-      BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
-      metrics.Begin();
+  size_t shards = 1;
+  if (program.present("--shards")) {
+    shards = std::stoi(program.get("--shards"));
+  }
 
-      size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
+  auto flush_thread = program.get<bool>("--flush-thread");
+  auto scan_hint = !program.get<bool>("--no-scan-hint");
+  auto scan_access_type = scan_hint ? AccessType::Scan : AccessType::Unknown;
 
-      while (!metrics.ShouldFinish()) {
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
-        if (page == nullptr) {
-          continue;
-        }
+  auto disk = program.get<std::string>("--disk");
+  auto read_only = program.get<bool>("--read-only") || disk == "mmap";
+  auto huge_pages = program.get<bool>("--huge-pages");
 
-        char &ch = page->GetData()[page_idx % 1024];
-        page->WLatch();
-        ch += 1;
-        if (ch == 0) {
-          ch = 1;
-        }
-        page->WUnlatch();
+  std::vector<ReplacerPolicy> policies;
+  try {
+    auto replacer = program.get<std::string>("--replacer");
+    if (replacer == "all") {
+      replacer = "lru-k,lru,clock,2q,arc";
+    }
+    for (const auto &name : bustub::StringUtil::Split(replacer, ',')) {
+      policies.push_back(bustub::ParseReplacerPolicy(name));
+    }
+  } catch (const bustub::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
 
-        bpm->UnpinPage(page->GetPageId(), true, AccessType::Scan);
-        page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
-        metrics.Tick();
-        metrics.Report();
+  std::vector<page_id_t> page_ids;
+  auto create_pages = [&page_ids](BufferPoolManager *bpm) {
+    for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      if (page == nullptr) {
+        throw std::runtime_error("new page failed");
       }
+      char &ch = page->GetData()[i % 1024];
+      ch = 1;
 
-      total_metrics.ReportScan(metrics.cnt_);
-    }));
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+  };
+
+  std::unique_ptr<DiskManager> disk_manager;
+  DiskManagerUnlimitedMemory *memory_disk = nullptr;
+  if (disk == "memory") {
+    auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+    memory_disk = dm.get();
+    disk_manager = std::move(dm);
+  } else {
+    // the file based disk managers all read the same file, written through the fstream disk manager beforehand. The
+    // compressed disk manager has its own file format and writes the file itself.
+    std::remove(BUSTUB_BENCH_DB_FILE);
+    std::unique_ptr<DiskManager> dm;
+    if (disk == "compressed") {
+      dm = std::make_unique<DiskManagerCompressed>(BUSTUB_BENCH_DB_FILE);
+    } else {
+      dm = std::make_unique<DiskManager>(BUSTUB_BENCH_DB_FILE);
+    }
+    auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, dm.get(), LRU_K_SIZE, nullptr, shards);
+    create_pages(bpm.get());
+    bpm->FlushAllPages();
+    bpm = nullptr;
+    dm->ShutDown();
+    if (disk == "fstream") {
+      disk_manager = std::make_unique<DiskManager>(BUSTUB_BENCH_DB_FILE);
+    } else if (disk == "posix") {
+      disk_manager = std::make_unique<DiskManagerPosix>(BUSTUB_BENCH_DB_FILE);
+    } else if (disk == "uring") {
+      disk_manager = std::make_unique<DiskManagerUring>(BUSTUB_BENCH_DB_FILE);
+    } else if (disk == "mmap") {
+      disk_manager = std::make_unique<DiskManagerMmap>(BUSTUB_BENCH_DB_FILE);
+    } else if (disk == "compressed") {
+      disk_manager = std::make_unique<DiskManagerCompressed>(BUSTUB_BENCH_DB_FILE);
+    } else {
+      std::cerr << "unknown disk manager " << disk << std::endl;
+      return 1;
+    }
+  }
+  if (memory_disk == nullptr) {
+    // latency can only be injected into the memory disk
+    latency_ms = 0;
   }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
-      std::random_device r;
-      std::default_random_engine gen(r());
-      zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
-
-      BpmMetrics metrics(fmt::format("get  {:>2}", thread_id), duration_ms);
-      metrics.Begin();
-
-      while (!metrics.ShouldFinish()) {
-        auto page_idx = dist(gen);
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Get);
-        if (page == nullptr) {
-          continue;
+  for (auto policy : policies) {
+    auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, shards,
+                                                   huge_pages, policy);
+
+    auto replacer = bustub::ReplacerPolicyToString(policy);
+    fmt::print(stderr,
+               "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, scan_thread_n={}, "
+               "get_thread_n={}, shards={}, scan_hint={}, flush_thread={}, disk={}, read_only={}, huge_pages={}, "
+               "replacer={}\n",
+               BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, scan_thread_n, get_thread_n, shards,
+               scan_hint, flush_thread, disk, read_only, huge_pages, replacer);
+
+    if (memory_disk != nullptr) {
+      memory_disk->SetLatency(0);
+      page_ids.clear();
+      create_pages(bpm.get());
+      // enable disk latency after creating all pages
+      memory_disk->SetLatency(latency_ms);
+    }
+    if (flush_thread) {
+      bpm->RunFlushThread();
+    }
+    bpm->ResetStats();
+
+    fmt::print(stderr, "[info] benchmark start\n");
+
+    BpmTotalMetrics total_metrics;
+    total_metrics.replacer_ = replacer;
+    total_metrics.Begin();
+
+    std::vector<std::thread> threads;
+
+    for (size_t thread_id = 0; thread_id < scan_thread_n; thread_id++) {
+      threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, scan_thread_n, scan_access_type,
+                                        read_only, &total_metrics] {
+        BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
+        metrics.Begin();
+
+        size_t page_idx = BUSTUB_PAGE_CNT * thread_id / scan_thread_n;
+
+        while (!metrics.ShouldFinish()) {
+          auto *page = bpm->FetchPage(page_ids[page_idx], scan_access_type);
+          if (page == nullptr) {
+            continue;
+          }
+
+          char &ch = page->GetData()[page_idx % 1024];
+          if (read_only) {
+            page->RLatch();
+            char value = ch;
+            page->RUnlatch();
+            if (value == 0) {
+              throw std::runtime_error("invalid data");
+            }
+          } else {
+            page->WLatch();
+            ch += 1;
+            if (ch == 0) {
+              ch = 1;
+            }
+            page->WUnlatch();
+          }
+
+          bpm->UnpinPage(page->GetPageId(), !read_only, scan_access_type);
+          page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
+          metrics.Tick();
+          metrics.Report();
         }
 
-        page->RLatch();
-        char ch = page->GetData()[page_idx % 1024];
-        page->RUnlatch();
-        if (ch == 0) {
-          throw std::runtime_error("invalid data");
+        total_metrics.ReportScan(metrics.cnt_);
+      }));
+    }
+
+    for (size_t thread_id = 0; thread_id < get_thread_n; thread_id++) {
+      threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, latency_ms, &total_metrics] {
+        std::random_device r;
+        std::default_random_engine gen(r());
+        zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
+
+        BpmMetrics metrics(fmt::format("get  {:>2}", thread_id), duration_ms);
+        metrics.Begin();
+        uint64_t miss_cnt = 0;
+
+        while (!metrics.ShouldFinish()) {
+          auto page_idx = dist(gen);
+          auto fetch_start = std::chrono::steady_clock::now();
+          auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Get);
+          if (page == nullptr) {
+            continue;
+          }
+          // A fetch that waited for at least one disk latency had to read the page.
+          if (std::chrono::steady_clock::now() - fetch_start >= std::chrono::milliseconds(latency_ms)) {
+            miss_cnt += 1;
+          }
+
+          page->RLatch();
+          char ch = page->GetData()[page_idx % 1024];
+          page->RUnlatch();
+          if (ch == 0) {
+            throw std::runtime_error("invalid data");
+          }
+
+          bpm->UnpinPage(page->GetPageId(), false, AccessType::Get);
+          metrics.Tick();
+          metrics.Report();
         }
 
-        bpm->UnpinPage(page->GetPageId(), false, AccessType::Get);
-        metrics.Tick();
-        metrics.Report();
-      }
+        total_metrics.ReportGet(metrics.cnt_, miss_cnt);
+      }));
+    }
 
-      total_metrics.ReportGet(metrics.cnt_);
-    }));
-  }
+    for (auto &thread : threads) {
+      thread.join();
+    }
 
-  for (auto &thread : threads) {
-    thread.join();
+    bpm->StopFlushThread();
+    auto stats = bpm->GetStats();
+    total_metrics.flushed_pages_ = stats.flushed_pages_;
+    total_metrics.dirty_victims_ = stats.dirty_victims_;
+    total_metrics.misses_ = stats.misses_;
+    total_metrics.fetch_miss_p99_ns_ = stats.fetch_miss_latency_.Percentile(0.99);
+
+    // Hits and misses are told apart by fetch latency, which needs an injected disk latency.
+    total_metrics.Report(latency_ms > 0);
+    if (auto *compressed = dynamic_cast<DiskManagerCompressed *>(disk_manager.get()); compressed != nullptr) {
+      fmt::print("compression_ratio={:.2f} stored_bytes={} file_bytes={}\n", compressed->GetCompressionRatio(),
+                 compressed->GetStoredBytes(), compressed->GetFileBytes());
+    }
   }
 
-  total_metrics.Report();
-
   return 0;
 }
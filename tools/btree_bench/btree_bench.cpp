@@ -22,6 +22,7 @@
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/key_search.h"
 #include "test_util.h"
 
 #include <sys/time.h>
@@ -119,6 +120,15 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--bpm-size").help("number of frames in the buffer pool");
+  program.add_argument("--swizzle")
+      .help("descend through the buffer pool's swips instead of page table lookups")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--scalar-search")
+      .help("search within nodes one key at a time instead of with SIMD")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -133,11 +143,21 @@ auto main(int argc, char **argv) -> int {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
+  size_t bpm_size = BUSTUB_BPM_SIZE;
+  if (program.present("--bpm-size")) {
+    bpm_size = std::stoi(program.get("--bpm-size"));
+  }
+  bool swizzle = program.get<bool>("--swizzle");
+  if (program.get<bool>("--scalar-search")) {
+    bustub::KeySearch::Use(bustub::KeySearch::Isa::SCALAR);
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto bpm = std::make_unique<BufferPoolManager>(bpm_size, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, swizzle={}, simd={}\n",
+             TOTAL_KEYS, duration_ms, LRU_K_SIZE, bpm_size, swizzle,
+             bustub::KeySearch::GetIsa() != bustub::KeySearch::Isa::SCALAR);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -145,8 +165,13 @@ auto main(int argc, char **argv) -> int {
   page_id_t page_id;
   auto header_page = bpm->NewPageGuarded(&page_id);
 
-  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
-                                                                                            bpm.get(), comparator);
+  // default node sizes, only spelled out to reach the swizzle flag
+  int leaf_max_size = (bustub::BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(bustub::GenericKey<8>)) /
+                      (sizeof(bustub::GenericKey<8>) + sizeof(bustub::RID));
+  int internal_max_size = (bustub::BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(bustub::GenericKey<8>)) /
+                          (sizeof(bustub::GenericKey<8>) + sizeof(page_id_t));
+  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index(
+      "foo_pk", page_id, bpm.get(), comparator, leaf_max_size, internal_max_size, swizzle);
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
     bustub::GenericKey<8> index_key;
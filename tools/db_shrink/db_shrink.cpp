@@ -0,0 +1,44 @@
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+
+#include "argparse/argparse.hpp"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+// Truncates the free pages at the end of a database file, see DiskManager::Shrink(). The database must not be in use.
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-db-shrink");
+  program.add_argument("db_file").help("the database file to shrink, must not be opened by a running instance");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get<std::string>("db_file");
+  struct stat st {};
+  if (stat(db_file.c_str(), &st) != 0) {
+    std::cerr << "database file " << db_file << " does not exist" << std::endl;
+    return 1;
+  }
+
+  try {
+    bustub::DiskManager disk_manager(db_file);
+    auto num_pages = disk_manager.GetNumPages();
+    auto num_free_pages = disk_manager.GetNumFreePages();
+    auto removed = disk_manager.Shrink();
+    fmt::print("{}: {} pages ({} free) -> {} pages ({} free), truncated {} pages\n", db_file, num_pages,
+               num_free_pages, disk_manager.GetNumPages(), disk_manager.GetNumFreePages(), removed);
+    disk_manager.ShutDown();
+  } catch (const bustub::Exception &ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}